@@ -3,16 +3,30 @@
 #ifndef EVALUATIONNODE
 #define EVALUATIONNODE
 
-#include "Table.hpp"
+#include <unordered_set>
+#include <string_view>
+#include <deque>
+#include <cstring>
+#include "../src/Table.hpp"
+#include "../src/ColumnSummary.hpp"
 
 struct EvaluationNode {
     virtual ~EvaluationNode() = default;
+
+    // called once at the start of each execution, before any row is evaluated
+    // nodes that read another table summarize it here instead of rescanning it for every row
+    virtual void open() {}
+
     virtual bool evaluate() = 0;
 };
 
 struct ParensNode : EvaluationNode {
     std::shared_ptr<EvaluationNode> subExpr = nullptr;
 
+    void open() override {
+        subExpr->open();
+    }
+
     bool evaluate() override {
         return subExpr->evaluate();
     }
@@ -21,6 +35,10 @@ struct ParensNode : EvaluationNode {
 struct NotNode : EvaluationNode {
     std::shared_ptr<EvaluationNode> subExpr = nullptr;
 
+    void open() override {
+        subExpr->open();
+    }
+
     bool evaluate() override {
         return !subExpr->evaluate();
     }
@@ -30,6 +48,11 @@ struct AndNode : EvaluationNode {
     std::shared_ptr<EvaluationNode> lhs = nullptr;
     std::shared_ptr<EvaluationNode> rhs = nullptr;
 
+    void open() override {
+        lhs->open();
+        rhs->open();
+    }
+
     bool evaluate() override {
         return lhs->evaluate() && rhs->evaluate();
     }
@@ -39,89 +62,110 @@ struct OrNode : EvaluationNode {
     std::shared_ptr<EvaluationNode> lhs = nullptr;
     std::shared_ptr<EvaluationNode> rhs = nullptr;
 
+    void open() override {
+        lhs->open();
+        rhs->open();
+    }
+
     bool evaluate() override {
         return lhs->evaluate() || rhs->evaluate();
     }
 };
 
+// x in t.c is true when x is not null and equals some non-null value of t.c
+// open() collects the non-null values of t.c into a hash set, so each row is one lookup
 struct IntInColumnNode : EvaluationNode {
     std::string lhsColumnName;
     Table& lhsRow;
     std::string rhsColumnName;
     Table rhsRow;
+    std::unordered_set<int> rhsValues;
 
     IntInColumnNode(const std::string& lhsColumnName, Table& lhsRow, const std::string& rhsColumnName, TableInfo rhsTableData)
         : lhsColumnName(lhsColumnName), lhsRow(lhsRow), rhsColumnName(rhsColumnName), rhsRow(rhsTableData) {}
 
-    bool evaluate() override {
+    void open() override {
+        rhsValues.clear();
         rhsRow.reset();
+        while (rhsRow.nextRow()) {
+            if (!rhsRow.isNull(rhsColumnName))
+                rhsValues.insert(rhsRow.getInt(rhsColumnName));
+        }
+    }
 
+    bool evaluate() override {
         if (lhsRow.isNull(lhsColumnName))
             return false;
 
-        while (rhsRow.nextRow()) {
-            if (rhsRow.isNull(rhsColumnName))
-                continue;
-
-            if (lhsRow.getInt(lhsColumnName) == rhsRow.getInt(rhsColumnName)) {
-                return true;
-            }
-        }
-        return false;
+        return rhsValues.count(lhsRow.getInt(lhsColumnName)) != 0;
     }
 };
 
+// -0.0 and 0.0 hash the same and NaN never matches, the same as ==
 struct FloatInColumnNode : EvaluationNode {
     std::string lhsColumnName;
     Table& lhsRow;
     std::string rhsColumnName;
     Table rhsRow;
+    std::unordered_set<float> rhsValues;
 
     FloatInColumnNode(const std::string& lhsColumnName, Table& lhsRow, const std::string& rhsColumnName, TableInfo rhsTableData)
         : lhsColumnName(lhsColumnName), lhsRow(lhsRow), rhsColumnName(rhsColumnName), rhsRow(rhsTableData) {}
 
-    bool evaluate() override {
+    void open() override {
+        rhsValues.clear();
         rhsRow.reset();
+        while (rhsRow.nextRow()) {
+            if (!rhsRow.isNull(rhsColumnName))
+                rhsValues.insert(rhsRow.getFloat(rhsColumnName));
+        }
+    }
 
+    bool evaluate() override {
         if (lhsRow.isNull(lhsColumnName))
             return false;
 
-        while (rhsRow.nextRow()) {
-            if (rhsRow.isNull(rhsColumnName))
-                continue;
-
-            if (lhsRow.getFloat(lhsColumnName) == rhsRow.getFloat(rhsColumnName)) {
-                return true;
-            }
-        }
-        return false;
+        return rhsValues.count(lhsRow.getFloat(lhsColumnName)) != 0;
     }
 };
 
+// values are compared without their '\0' padding, so columns of different lengths still match
+// lookups view the lhs row's bytes directly instead of copying them into a string
 struct CharsInColumnNode : EvaluationNode {
     std::string lhsColumnName;
     Table& lhsRow;
     std::string rhsColumnName;
     Table rhsRow;
+    std::deque<std::string> rhsStorage; // owns what rhsValues views. a deque never moves its elements
+    std::unordered_set<std::string_view> rhsValues;
+    int lhsCharsLength;
 
     CharsInColumnNode(const std::string& lhsColumnName, Table& lhsRow, const std::string& rhsColumnName, TableInfo rhsTableData)
-        : lhsColumnName(lhsColumnName), lhsRow(lhsRow), rhsColumnName(rhsColumnName), rhsRow(rhsTableData) {}
+        : lhsColumnName(lhsColumnName), lhsRow(lhsRow), rhsColumnName(rhsColumnName), rhsRow(rhsTableData),
+          lhsCharsLength(lhsRow.t[lhsColumnName]->charsLength) {}
 
-    bool evaluate() override {
+    void open() override {
+        rhsValues.clear();
+        rhsStorage.clear();
         rhsRow.reset();
-
-        if (lhsRow.isNull(lhsColumnName))
-            return false;
-
         while (rhsRow.nextRow()) {
             if (rhsRow.isNull(rhsColumnName))
                 continue;
-                
-            if (lhsRow.getChars(lhsColumnName) == rhsRow.getChars(rhsColumnName)) {
-                return true;
+            std::string value = rhsRow.getChars(rhsColumnName);
+            if (rhsValues.count(value) == 0) {
+                rhsStorage.push_back(value);
+                rhsValues.insert(rhsStorage.back());
             }
         }
-        return false;
+    }
+
+    bool evaluate() override {
+        if (lhsRow.isNull(lhsColumnName))
+            return false;
+
+        const char* value = lhsRow.getBytes(lhsColumnName) + 1;
+        const char* end = static_cast<const char*>(std::memchr(value, '\0', lhsCharsLength));
+        return rhsValues.count(std::string_view(value, end ? end - value : lhsCharsLength)) != 0;
     }
 };
 
@@ -130,25 +174,31 @@ struct BoolInColumnNode : EvaluationNode {
     Table& lhsRow;
     std::string rhsColumnName;
     Table rhsRow;
+    bool rhsHasTrue = false;
+    bool rhsHasFalse = false;
 
     BoolInColumnNode(const std::string& lhsColumnName, Table& lhsRow, const std::string& rhsColumnName, TableInfo rhsTableData)
         : lhsColumnName(lhsColumnName), lhsRow(lhsRow), rhsColumnName(rhsColumnName), rhsRow(rhsTableData) {}
 
-    bool evaluate() override {
+    void open() override {
+        rhsHasTrue = false;
+        rhsHasFalse = false;
         rhsRow.reset();
+        while (!(rhsHasTrue && rhsHasFalse) && rhsRow.nextRow()) {
+            if (rhsRow.isNull(rhsColumnName))
+                continue;
+            if (rhsRow.getBool(rhsColumnName))
+                rhsHasTrue = true;
+            else
+                rhsHasFalse = true;
+        }
+    }
 
+    bool evaluate() override {
         if (lhsRow.isNull(lhsColumnName))
             return false;
 
-        while (rhsRow.nextRow()) {
-            if (rhsRow.isNull(rhsColumnName))
-                continue;
-
-            if (lhsRow.getBool(lhsColumnName) == rhsRow.getBool(rhsColumnName)) {
-                return true;
-            }
-        }
-        return false;
+        return lhsRow.getBool(lhsColumnName) ? rhsHasTrue : rhsHasFalse;
     }
 };
 
@@ -158,57 +208,27 @@ struct IntAnyColumnComparisonNode : EvaluationNode {
     element_type op;
     std::string rhsColumnName;
     Table rhsRow;
+    ColumnSummary<int> rhsSummary;
 
     IntAnyColumnComparisonNode(const std::string& lhsColumnName, Table& lhsRow, element_type op, const std::string& rhsColumnName, TableInfo rhsTableData)
         : lhsColumnName(lhsColumnName), lhsRow(lhsRow), op(op), rhsColumnName(rhsColumnName), rhsRow(rhsTableData) {}
 
-    bool evaluate() override {
+    void open() override {
+        rhsSummary = ColumnSummary<int>();
         rhsRow.reset();
+        while (rhsRow.nextRow()) {
+            if (rhsRow.isNull(rhsColumnName))
+                rhsSummary.addNull();
+            else
+                rhsSummary.add(rhsRow.getInt(rhsColumnName));
+        }
+    }
 
+    bool evaluate() override {
         if (lhsRow.isNull(lhsColumnName))
             return false;
 
-        // on evaluation of each lhs row, scan the whole rhs column
-        // if ever the condition is satisfied, return true
-        // the condition cannot be satisfied on a null in the rhs 
-        while (rhsRow.nextRow()) {
-            if (rhsRow.isNull(rhsColumnName))
-                continue;
-
-            switch (op) {
-                case op_equals:
-                    
-                    if (lhsRow.getInt(lhsColumnName) == rhsRow.getInt(rhsColumnName))
-                        return true;
-                    break;
-
-                case op_not_equals:
-                    if (lhsRow.getInt(lhsColumnName) != rhsRow.getInt(rhsColumnName))
-                        return true;
-                    break;
-
-                case op_less_than:
-                    if (lhsRow.getInt(lhsColumnName) < rhsRow.getInt(rhsColumnName))
-                        return true;
-                    break;
-
-                case op_less_than_equals:
-                    if (lhsRow.getInt(lhsColumnName) <= rhsRow.getInt(rhsColumnName))
-                        return true;
-                    break;
-                
-                case op_greater_than:
-                    if (lhsRow.getInt(lhsColumnName) > rhsRow.getInt(rhsColumnName))
-                        return true;
-                    break;
-
-                case op_greater_than_equals:
-                    if (lhsRow.getInt(lhsColumnName) >= rhsRow.getInt(rhsColumnName))
-                        return true;
-                    break;
-            }
-        }
-        return false;
+        return rhsSummary.any(op, lhsRow.getInt(lhsColumnName));
     }
 };
 
@@ -218,57 +238,27 @@ struct FloatAnyColumnComparisonNode : EvaluationNode {
     element_type op;
     std::string rhsColumnName;
     Table rhsRow;
+    ColumnSummary<float> rhsSummary;
 
     FloatAnyColumnComparisonNode(const std::string& lhsColumnName, Table& lhsRow, element_type op, const std::string& rhsColumnName, TableInfo rhsTableData)
         : lhsColumnName(lhsColumnName), lhsRow(lhsRow), op(op), rhsColumnName(rhsColumnName), rhsRow(rhsTableData) {}
 
-    bool evaluate() override {
+    void open() override {
+        rhsSummary = ColumnSummary<float>();
         rhsRow.reset();
+        while (rhsRow.nextRow()) {
+            if (rhsRow.isNull(rhsColumnName))
+                rhsSummary.addNull();
+            else
+                rhsSummary.add(rhsRow.getFloat(rhsColumnName));
+        }
+    }
 
+    bool evaluate() override {
         if (lhsRow.isNull(lhsColumnName))
             return false;
 
-        // on evaluation of each lhs row, scan the whole rhs column
-        // if ever the condition is satisfied, return true
-        // the condition cannot be satisfied on a null in the rhs 
-        while (rhsRow.nextRow()) {
-            if (rhsRow.isNull(rhsColumnName))
-                continue;
-
-            switch (op) {
-                case op_equals:
-                    
-                    if (lhsRow.getFloat(lhsColumnName) == rhsRow.getFloat(rhsColumnName))
-                        return true;
-                    break;
-
-                case op_not_equals:
-                    if (lhsRow.getFloat(lhsColumnName) != rhsRow.getFloat(rhsColumnName))
-                        return true;
-                    break;
-
-                case op_less_than:
-                    if (lhsRow.getFloat(lhsColumnName) < rhsRow.getFloat(rhsColumnName))
-                        return true;
-                    break;
-
-                case op_less_than_equals:
-                    if (lhsRow.getFloat(lhsColumnName) <= rhsRow.getFloat(rhsColumnName))
-                        return true;
-                    break;
-                
-                case op_greater_than:
-                    if (lhsRow.getFloat(lhsColumnName) > rhsRow.getFloat(rhsColumnName))
-                        return true;
-                    break;
-
-                case op_greater_than_equals:
-                    if (lhsRow.getFloat(lhsColumnName) >= rhsRow.getFloat(rhsColumnName))
-                        return true;
-                    break;
-            }
-        }
-        return false;
+        return rhsSummary.any(op, lhsRow.getFloat(lhsColumnName));
     }
 };
 
@@ -278,57 +268,27 @@ struct CharsAnyColumnComparisonNode : EvaluationNode {
     element_type op;
     std::string rhsColumnName;
     Table rhsRow;
+    ColumnSummary<std::string> rhsSummary;
 
     CharsAnyColumnComparisonNode(const std::string& lhsColumnName, Table& lhsRow, element_type op, const std::string& rhsColumnName, TableInfo rhsTableData)
         : lhsColumnName(lhsColumnName), lhsRow(lhsRow), op(op), rhsColumnName(rhsColumnName), rhsRow(rhsTableData) {}
 
-    bool evaluate() override {
+    void open() override {
+        rhsSummary = ColumnSummary<std::string>();
         rhsRow.reset();
+        while (rhsRow.nextRow()) {
+            if (rhsRow.isNull(rhsColumnName))
+                rhsSummary.addNull();
+            else
+                rhsSummary.add(rhsRow.getChars(rhsColumnName));
+        }
+    }
 
+    bool evaluate() override {
         if (lhsRow.isNull(lhsColumnName))
             return false;
 
-        // on evaluation of each lhs row, scan the whole rhs column
-        // if ever the condition is satisfied, return true
-        // the condition cannot be satisfied on a null in the rhs 
-        while (rhsRow.nextRow()) {
-            if (rhsRow.isNull(rhsColumnName))
-                continue;
-
-            switch (op) {
-                case op_equals:
-                    
-                    if (lhsRow.getChars(lhsColumnName) == rhsRow.getChars(rhsColumnName))
-                        return true;
-                    break;
-
-                case op_not_equals:
-                    if (lhsRow.getChars(lhsColumnName) != rhsRow.getChars(rhsColumnName))
-                        return true;
-                    break;
-
-                case op_less_than:
-                    if (lhsRow.getChars(lhsColumnName) < rhsRow.getChars(rhsColumnName))
-                        return true;
-                    break;
-
-                case op_less_than_equals:
-                    if (lhsRow.getChars(lhsColumnName) <= rhsRow.getChars(rhsColumnName))
-                        return true;
-                    break;
-                
-                case op_greater_than:
-                    if (lhsRow.getChars(lhsColumnName) > rhsRow.getChars(rhsColumnName))
-                        return true;
-                    break;
-
-                case op_greater_than_equals:
-                    if (lhsRow.getChars(lhsColumnName) >= rhsRow.getChars(rhsColumnName))
-                        return true;
-                    break;
-            }
-        }
-        return false;
+        return rhsSummary.any(op, lhsRow.getChars(lhsColumnName));
     }
 };
 
@@ -338,37 +298,27 @@ struct BoolAnyColumnComparisonNode : EvaluationNode {
     element_type op;
     std::string rhsColumnName;
     Table rhsRow;
+    ColumnSummary<bool> rhsSummary;
 
     BoolAnyColumnComparisonNode(const std::string& lhsColumnName, Table& lhsRow, element_type op, const std::string& rhsColumnName, TableInfo rhsTableData)
         : lhsColumnName(lhsColumnName), lhsRow(lhsRow), op(op), rhsColumnName(rhsColumnName), rhsRow(rhsTableData) {}
 
-    bool evaluate() override {
+    void open() override {
+        rhsSummary = ColumnSummary<bool>();
         rhsRow.reset();
+        while (rhsRow.nextRow()) {
+            if (rhsRow.isNull(rhsColumnName))
+                rhsSummary.addNull();
+            else
+                rhsSummary.add(rhsRow.getBool(rhsColumnName));
+        }
+    }
 
+    bool evaluate() override {
         if (lhsRow.isNull(lhsColumnName))
             return false;
 
-        // on evaluation of each lhs row, scan the whole rhs column
-        // if ever the condition is satisfied, return true
-        // the condition cannot be satisfied on a null in the rhs 
-        while (rhsRow.nextRow()) {
-            if (rhsRow.isNull(rhsColumnName))
-                continue;
-
-            switch (op) {
-                case op_equals:
-                    
-                    if (lhsRow.getBool(lhsColumnName) == rhsRow.getBool(rhsColumnName))
-                        return true;
-                    break;
-
-                case op_not_equals:
-                    if (lhsRow.getBool(lhsColumnName) != rhsRow.getBool(rhsColumnName))
-                        return true;
-                    break;
-            }
-        }
-        return false;
+        return rhsSummary.any(op, lhsRow.getBool(lhsColumnName));
     }
 };
 
@@ -378,56 +328,27 @@ struct IntAllColumnComparisonNode : EvaluationNode {
     element_type op;
     std::string rhsColumnName;
     Table rhsRow;
+    ColumnSummary<int> rhsSummary;
 
     IntAllColumnComparisonNode(const std::string& lhsColumnName, Table& lhsRow, element_type op, const std::string& rhsColumnName, TableInfo rhsTableData)
         : lhsColumnName(lhsColumnName), lhsRow(lhsRow), op(op), rhsColumnName(rhsColumnName), rhsRow(rhsTableData) {}
 
-    bool evaluate() override {
+    void open() override {
+        rhsSummary = ColumnSummary<int>();
         rhsRow.reset();
+        while (rhsRow.nextRow()) {
+            if (rhsRow.isNull(rhsColumnName))
+                rhsSummary.addNull();
+            else
+                rhsSummary.add(rhsRow.getInt(rhsColumnName));
+        }
+    }
 
+    bool evaluate() override {
         if (lhsRow.isNull(lhsColumnName))
             return false;
 
-        // on evaluation of each lhs row, scan the whole rhs column
-        // if ever the condition is not true return false
-        // on nulls in the rhs, return false. this is mysql behavior, too
-        while (rhsRow.nextRow()) {
-            if (rhsRow.isNull(rhsColumnName))
-                return false;
-
-            switch (op) {
-                case op_equals:
-                    if ( !(lhsRow.getInt(lhsColumnName) == rhsRow.getInt(rhsColumnName)) )
-                        return false;
-                    break;
-
-                case op_not_equals:
-                    if ( !(lhsRow.getInt(lhsColumnName) != rhsRow.getInt(rhsColumnName)) )
-                        return false;
-                    break;
-
-                case op_less_than:
-                    if ( !(lhsRow.getInt(lhsColumnName) < rhsRow.getInt(rhsColumnName)) )
-                        return false;
-                    break;
-
-                case op_less_than_equals:
-                    if ( !(lhsRow.getInt(lhsColumnName) <= rhsRow.getInt(rhsColumnName)) )
-                        return false;
-                    break;
-                
-                case op_greater_than:
-                    if ( !(lhsRow.getInt(lhsColumnName) > rhsRow.getInt(rhsColumnName)) )
-                        return false;
-                    break;
-
-                case op_greater_than_equals:
-                    if ( !(lhsRow.getInt(lhsColumnName) >= rhsRow.getInt(rhsColumnName)) )
-                        return false;
-                    break;
-            }
-        }
-        return true;
+        return rhsSummary.all(op, lhsRow.getInt(lhsColumnName));
     }
 };
 
@@ -437,56 +358,27 @@ struct FloatAllColumnComparisonNode : EvaluationNode {
     element_type op;
     std::string rhsColumnName;
     Table rhsRow;
+    ColumnSummary<float> rhsSummary;
 
     FloatAllColumnComparisonNode(const std::string& lhsColumnName, Table& lhsRow, element_type op, const std::string& rhsColumnName, TableInfo rhsTableData)
         : lhsColumnName(lhsColumnName), lhsRow(lhsRow), op(op), rhsColumnName(rhsColumnName), rhsRow(rhsTableData) {}
 
-    bool evaluate() override {
+    void open() override {
+        rhsSummary = ColumnSummary<float>();
         rhsRow.reset();
+        while (rhsRow.nextRow()) {
+            if (rhsRow.isNull(rhsColumnName))
+                rhsSummary.addNull();
+            else
+                rhsSummary.add(rhsRow.getFloat(rhsColumnName));
+        }
+    }
 
+    bool evaluate() override {
         if (lhsRow.isNull(lhsColumnName))
             return false;
 
-        // on evaluation of each lhs row, scan the whole rhs column
-        // if ever the condition is not true return false
-        // on nulls in the rhs, return false. this is mysql behavior, too
-        while (rhsRow.nextRow()) {
-            if (rhsRow.isNull(rhsColumnName))
-                return false;
-
-            switch (op) {
-                case op_equals:
-                    if ( !(lhsRow.getFloat(lhsColumnName) == rhsRow.getFloat(rhsColumnName)) )
-                        return false;
-                    break;
-
-                case op_not_equals:
-                    if ( !(lhsRow.getFloat(lhsColumnName) != rhsRow.getFloat(rhsColumnName)) )
-                        return false;
-                    break;
-
-                case op_less_than:
-                    if ( !(lhsRow.getFloat(lhsColumnName) < rhsRow.getFloat(rhsColumnName)) )
-                        return false;
-                    break;
-
-                case op_less_than_equals:
-                    if ( !(lhsRow.getFloat(lhsColumnName) <= rhsRow.getFloat(rhsColumnName)) )
-                        return false;
-                    break;
-                
-                case op_greater_than:
-                    if ( !(lhsRow.getFloat(lhsColumnName) > rhsRow.getFloat(rhsColumnName)) )
-                        return false;
-                    break;
-
-                case op_greater_than_equals:
-                    if ( !(lhsRow.getFloat(lhsColumnName) >= rhsRow.getFloat(rhsColumnName)) )
-                        return false;
-                    break;
-            }
-        }
-        return true;
+        return rhsSummary.all(op, lhsRow.getFloat(lhsColumnName));
     }
 };
 
@@ -496,56 +388,27 @@ struct CharsAllColumnComparisonNode : EvaluationNode {
     element_type op;
     std::string rhsColumnName;
     Table rhsRow;
+    ColumnSummary<std::string> rhsSummary;
 
     CharsAllColumnComparisonNode(const std::string& lhsColumnName, Table& lhsRow, element_type op, const std::string& rhsColumnName, TableInfo rhsTableData)
         : lhsColumnName(lhsColumnName), lhsRow(lhsRow), op(op), rhsColumnName(rhsColumnName), rhsRow(rhsTableData) {}
 
-    bool evaluate() override {
+    void open() override {
+        rhsSummary = ColumnSummary<std::string>();
         rhsRow.reset();
+        while (rhsRow.nextRow()) {
+            if (rhsRow.isNull(rhsColumnName))
+                rhsSummary.addNull();
+            else
+                rhsSummary.add(rhsRow.getChars(rhsColumnName));
+        }
+    }
 
+    bool evaluate() override {
         if (lhsRow.isNull(lhsColumnName))
             return false;
 
-        // on evaluation of each lhs row, scan the whole rhs column
-        // if ever the condition is not true return false
-        // on nulls in the rhs, return false. this is mysql behavior, too
-        while (rhsRow.nextRow()) {
-            if (rhsRow.isNull(rhsColumnName))
-                return false;
-
-            switch (op) {
-                case op_equals:
-                    if ( !(lhsRow.getChars(lhsColumnName) == rhsRow.getChars(rhsColumnName)) )
-                        return false;
-                    break;
-
-                case op_not_equals:
-                    if ( !(lhsRow.getChars(lhsColumnName) != rhsRow.getChars(rhsColumnName)) )
-                        return false;
-                    break;
-
-                case op_less_than:
-                    if ( !(lhsRow.getChars(lhsColumnName) < rhsRow.getChars(rhsColumnName)) )
-                        return false;
-                    break;
-
-                case op_less_than_equals:
-                    if ( !(lhsRow.getChars(lhsColumnName) <= rhsRow.getChars(rhsColumnName)) )
-                        return false;
-                    break;
-                
-                case op_greater_than:
-                    if ( !(lhsRow.getChars(lhsColumnName) > rhsRow.getChars(rhsColumnName)) )
-                        return false;
-                    break;
-
-                case op_greater_than_equals:
-                    if ( !(lhsRow.getChars(lhsColumnName) >= rhsRow.getChars(rhsColumnName)) )
-                        return false;
-                    break;
-            }
-        }
-        return true;
+        return rhsSummary.all(op, lhsRow.getChars(lhsColumnName));
     }
 };
 
@@ -555,36 +418,27 @@ struct BoolAllColumnComparisonNode : EvaluationNode {
     element_type op;
     std::string rhsColumnName;
     Table rhsRow;
+    ColumnSummary<bool> rhsSummary;
 
     BoolAllColumnComparisonNode(const std::string& lhsColumnName, Table& lhsRow, element_type op, const std::string& rhsColumnName, TableInfo rhsTableData)
         : lhsColumnName(lhsColumnName), lhsRow(lhsRow), op(op), rhsColumnName(rhsColumnName), rhsRow(rhsTableData) {}
 
-    bool evaluate() override {
+    void open() override {
+        rhsSummary = ColumnSummary<bool>();
         rhsRow.reset();
+        while (rhsRow.nextRow()) {
+            if (rhsRow.isNull(rhsColumnName))
+                rhsSummary.addNull();
+            else
+                rhsSummary.add(rhsRow.getBool(rhsColumnName));
+        }
+    }
 
+    bool evaluate() override {
         if (lhsRow.isNull(lhsColumnName))
             return false;
 
-        // on evaluation of each lhs row, scan the whole rhs column
-        // if ever the condition is not true return false
-        // on nulls in the rhs, return false. this is mysql behavior, too
-        while (rhsRow.nextRow()) {
-            if (rhsRow.isNull(rhsColumnName))
-                return false;
-
-            switch (op) {
-                case op_equals:
-                    if ( !(lhsRow.getBool(lhsColumnName) == rhsRow.getBool(rhsColumnName)) )
-                        return false;
-                    break;
-
-                case op_not_equals:
-                    if ( !(lhsRow.getBool(lhsColumnName) != rhsRow.getBool(rhsColumnName)) )
-                        return false;
-                    break;
-            }
-        }
-        return true;
+        return rhsSummary.all(op, lhsRow.getBool(lhsColumnName));
     }
 };
 
@@ -621,6 +475,7 @@ struct IntColumnComparisonNode : EvaluationNode {
             case op_greater_than_equals:
                 return row.getInt(lhsColumnName) >= row.getInt(rhsColumnName);
         }
+        return false;
     }
 };
 
@@ -657,6 +512,7 @@ struct FloatColumnComparisonNode : EvaluationNode {
             case op_greater_than_equals:
                 return row.getFloat(lhsColumnName) >= row.getFloat(rhsColumnName);
         }
+        return false;
     }
 };
 
@@ -693,6 +549,7 @@ struct CharsColumnComparisonNode : EvaluationNode {
             case op_greater_than_equals:
                 return row.getChars(lhsColumnName) >= row.getChars(rhsColumnName);
         }
+        return false;
     }
 };
 
@@ -717,6 +574,7 @@ struct BoolColumnComparisonNode : EvaluationNode {
             case op_not_equals:
                 return row.getBool(lhsColumnName) != row.getBool(rhsColumnName);
         }
+        return false;
     }
 };
 
@@ -753,6 +611,7 @@ struct IntLiteralComparisonNode : EvaluationNode {
             case op_greater_than_equals:
                 return row.getInt(lhsColumnName) >= literalValue;
         }
+        return false;
     }
 };
 
@@ -789,6 +648,7 @@ struct FloatLiteralComparisonNode : EvaluationNode {
             case op_greater_than_equals:
                 return row.getFloat(lhsColumnName) >= literalValue;
         }
+        return false;
     }
 };
 
@@ -825,6 +685,7 @@ struct CharsLiteralComparisonNode : EvaluationNode {
             case op_greater_than_equals:
                 return row.getChars(lhsColumnName) >= literalValue;
         }
+        return false;
     }
 };
 
@@ -850,6 +711,7 @@ struct BoolLiteralComparisonNode : EvaluationNode {
                 return row.getBool(lhsColumnName) != literalValue;
 
         }
+        return false;
     }
 };
 
@@ -868,6 +730,7 @@ struct TypeAgnosticNullComparisonNode : EvaluationNode {
             case op_not_equals:
                 return !row.isNull(lhsColumnName);
         }
+        return false;
     }
 };
 
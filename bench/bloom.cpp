@@ -0,0 +1,60 @@
+// bloom.cpp
+
+// ns per x in t.c lookup in a ColumnSummary, with and without the BloomFilter finish() puts in front of a large set,
+// for rhs columns of growing size, when 1 in 100 lhs values is in the set. also the filter's measured false positive rate
+// the smallest column is below ColumnSummary::BLOOM_MIN_VALUES, so it gets no filter. both ways must find the same values
+//
+//     make bench && ./bench/bloom.o [lookups]
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <random>
+#include "../src/ColumnSummary.hpp"
+
+int main(int argc, char** argv) {
+    size_t lookups = argc > 1 ? std::stoul(argv[1]) : 20000000;
+
+    std::cout << std::left << std::setw(12) << "rhs values" << std::right << std::setw(14) << "set ns/probe" << std::setw(16) << "bloom ns/probe"
+              << std::setw(10) << "speedup" << std::setw(18) << "false positives\n";
+
+    std::mt19937_64 random(1);
+    for (size_t size : {1u << 13, 1u << 16, 1u << 18, 1u << 20, 1u << 22}) {
+        // rhs values are even, so an odd lhs value is never in the set
+        ColumnSummary<int> plain;
+        for (size_t i = 0; i < size; ++i)
+            plain.add(int(random() % (size * 64)) & ~1);
+        ColumnSummary<int> filtered = plain;
+        filtered.finish();
+
+        std::vector<int> lhs(1 << 20);
+        for (int& x : lhs)
+            x = random() % 100 == 0 ? int(random() % (size * 64)) & ~1 : int(random() % (size * 64)) | 1;
+
+        size_t found = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < lookups; ++i)
+            found += plain.any<std::equal_to<>>(lhs[i & (lhs.size() - 1)]);
+        double setNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / lookups;
+
+        BloomStats stats;
+        size_t filteredFound = 0;
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < lookups; ++i)
+            filteredFound += filtered.any<std::equal_to<>>(lhs[i & (lhs.size() - 1)], &stats);
+        double bloomNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / lookups;
+
+        std::cout << std::left << std::setw(12) << plain.values.size() << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(14) << setNs << std::setw(16) << bloomNs << std::setw(9) << setNs / bloomNs << "x"
+                  << std::setw(16) << std::setprecision(3);
+        if (filtered.bloom.enabled())
+            std::cout << 100 * stats.falsePositiveRate() << "%\n";
+        else
+            std::cout << "no filter\n";
+        if (found != filteredFound) {
+            std::cout << "MISMATCH: the set found " << found << " values, the set behind the bloom filter found " << filteredFound << "\n";
+            return 1;
+        }
+    }
+}
@@ -1,42 +1,46 @@
 // convert.hpp
 
+// the evaluation tree where clauses were run on before compileProgram(), kept as a reference for bench/predicate.cpp
+
 #ifndef PREPROCESSOR
 #define PREPROCESSOR
 
-#include "node.hpp"
-#include "TableInfo.hpp"
-#include "Table.hpp"
+#include "../src/node.hpp"
+#include "../src/TableInfo.hpp"
+#include "../src/Table.hpp"
+#include "../src/Parameters.hpp"
 #include "EvaluationNode.hpp"
 
-std::shared_ptr<EvaluationNode> convert(std::shared_ptr<node> boolExprRoot, Table& rowItReference, const TableInfo& t) {
+// parameters gets a binder for every ?N in the expression, so binding a new value updates the tree in place
+std::shared_ptr<EvaluationNode> convert(std::shared_ptr<node> boolExprRoot, Table& rowItReference, const TableInfo& t, Parameters& parameters) {
 
     // (bool_expr)
     if (boolExprRoot->components.size() == 1 /*only child: boolExprRoot->components[0]->type == bool_expr*/) {
         ParensNode pn;
-        pn.subExpr = convert(boolExprRoot->components[0], rowItReference, t);
+        pn.subExpr = convert(boolExprRoot->components[0], rowItReference, t, parameters);
         return std::make_shared<ParensNode>(pn);
     }
 
     // !(bool_expr)
     else if (boolExprRoot->components[0]->type == op_not) {
         NotNode nn;
-        nn.subExpr = convert(boolExprRoot->components[1], rowItReference, t);
+        nn.subExpr = convert(boolExprRoot->components[1], rowItReference, t, parameters);
         return std::make_shared<NotNode>(nn);
     }
 
     // bool_expr op_or bool_expr
     else if (boolExprRoot->components[1]->type == op_or) {
         OrNode on;
-        on.lhs = convert(boolExprRoot->components[0], rowItReference, t);
-        on.rhs = convert(boolExprRoot->components[2], rowItReference, t);
+        on.lhs = convert(boolExprRoot->components[0], rowItReference, t, parameters);
+        on.rhs = convert(boolExprRoot->components[2], rowItReference, t, parameters);
         return std::make_shared<OrNode>(on);
     }
 
     // bool_expr op_and bool_expr
     else if (boolExprRoot->components[1]->type == op_and) {
         AndNode an;
-        an.lhs = convert(boolExprRoot->components[0], rowItReference, t);
-        an.rhs = convert(boolExprRoot->components[2], rowItReference, t);
+        an.lhs = convert(boolExprRoot->components[0], rowItReference, t, parameters);
+        an.rhs = convert(boolExprRoot->components[2], rowItReference, t, parameters);
         return std::make_shared<AndNode>(an);
     }
 
@@ -150,7 +154,39 @@ std::shared_ptr<EvaluationNode> convert(std::shared_ptr<node> boolExprRoot, Tabl
         else if (boolExprRoot->components[2]->type == kw_null) {
             return std::make_shared<TypeAgnosticNullComparisonNode>(boolExprRoot->components[0]->value, boolExprRoot->components[1]->type, rowItReference);
         }
+
+        // rhs parameter, the literal is filled in by a binder whenever a value is bound
+        else if (boolExprRoot->components[2]->type == parameter) {
+            int index = stoi(boolExprRoot->components[2]->value);
+            auto lhsColumn = find(boolExprRoot->components[0]->value, t.columns);
+            element_type op = boolExprRoot->components[1]->type;
+
+            switch (lhsColumn->type) {
+                case int_literal: {
+                    auto n = std::make_shared<IntLiteralComparisonNode>(lhsColumn->name, op, 0, rowItReference);
+                    parameters.addBinder(index, [n](const std::string& value){ n->literalValue = stoi(value); });
+                    return n;
+                }
+                case float_literal: {
+                    auto n = std::make_shared<FloatLiteralComparisonNode>(lhsColumn->name, op, 0, rowItReference);
+                    parameters.addBinder(index, [n](const std::string& value){ n->literalValue = stof(value); });
+                    return n;
+                }
+                case chars_literal: {
+                    std::string unbound;
+                    auto n = std::make_shared<CharsLiteralComparisonNode>(lhsColumn->name, op, unbound, rowItReference);
+                    parameters.addBinder(index, [n](const std::string& value){ n->literalValue = value; });
+                    return n;
+                }
+                case bool_literal: {
+                    auto n = std::make_shared<BoolLiteralComparisonNode>(lhsColumn->name, op, false, rowItReference);
+                    parameters.addBinder(index, [n](const std::string& value){ n->literalValue = value == "true"; });
+                    return n;
+                }
+            }
+        }
     }
+    return nullptr;
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,100 @@
+// distinct.cpp
+
+// ms per select distinct from a table of an int, a float, and a chars column, with fewer and fewer rows the same, against the plain
+// select it's run on top of. then again with DISTINCT_MEMORY_BUDGET cut to a few thousand rows' worth, so all but the first rows
+// it sees spill and are made distinct partition by partition. both ways must give the same rows, in any order.
+// the table is written to a temporary directory and removed after
+//
+//     make bench && ./bench/distinct.o [rows]
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <filesystem>
+#include "../src/token.hpp"
+#include "../src/tokenize.hpp"
+#include "../src/parser.hpp"
+#include "../src/execute.hpp"
+
+// the rows, in the order they came
+struct CollectingSink : ResultSink {
+    unsigned int rowSize = 0;
+    std::vector<std::string> rows;
+    void begin(const std::string& statement, const std::string& tables, const TableInfo& layout) override {
+        rowSize = layout.rowSize();
+        rows.clear();
+    }
+    void row(const char* rowBytes) override {
+        rows.emplace_back(rowBytes, rowSize);
+    }
+};
+
+// rows rows of values distinct different rows, in a scattered order
+void writeTable(const std::string& name, size_t rows, size_t distinct) {
+    TableInfo layout(name, {ColumnInfo("id", int_literal, 0), ColumnInfo("value", float_literal, 0), ColumnInfo("label", chars_literal, 12)});
+    TableWriter writer(name);
+    writer.begin("define", name, layout);
+    std::vector<char> row(layout.rowSize(), '\0');
+    for (size_t i = 0; i < rows; ++i) {
+        int id = int(i * 2654435761u % distinct);
+        *(int*)(row.data() + layout.columns[0].offset + 1) = id;
+        *(float*)(row.data() + layout.columns[1].offset + 1) = id * 0.25f;
+        std::string label = "row" + std::to_string(id % 1000);
+        std::fill(row.begin() + layout.columns[2].offset + 1, row.begin() + layout.columns[2].offset + 1 + 12, '\0');
+        std::copy(label.begin(), label.end(), row.begin() + layout.columns[2].offset + 1);
+        writer.row(row.data());
+    }
+    writer.end();
+}
+
+// ms to run the selection into sink
+double timeSelection(const std::string& selection, CollectingSink& sink, DistinctStats* stats = nullptr) {
+    Parameters parameters;
+    SelectionPlan plan(Parser(tokenize(selection)).parse()->components[0], parameters);
+    auto start = std::chrono::steady_clock::now();
+    plan.run(sink);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (stats)
+        *stats = plan.distinctStats;
+    return ms;
+}
+
+int main(int argc, char** argv) {
+    size_t rows = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "femtoql_distinct_bench";
+    std::filesystem::create_directories(directory);
+    TABLE_DIRECTORY = directory.string() + "/";
+    SPILL_DIRECTORY = directory.string();
+    size_t budget = DISTINCT_MEMORY_BUDGET;
+
+    std::cout << std::left << std::setw(12) << "rows" << std::setw(12) << "distinct" << std::right << std::setw(12) << "select ms"
+              << std::setw(14) << "distinct ms" << std::setw(14) << "spilling ms" << "  spilled\n";
+
+    for (size_t distinct = 10; distinct <= rows; distinct *= 100) {
+        writeTable("bench", rows, distinct);
+
+        CollectingSink all, hashed, spilled;
+        double selectMs = timeSelection("select from bench: *", all);
+        double distinctMs = timeSelection("select distinct from bench: *", hashed);
+        DISTINCT_MEMORY_BUDGET = 4096 * (all.rowSize + HASH_BYTES_PER_ROW);
+        DistinctStats stats;
+        double spilledMs = timeSelection("select distinct from bench: *", spilled, &stats);
+        DISTINCT_MEMORY_BUDGET = budget;
+
+        std::cout << std::left << std::setw(12) << rows << std::setw(12) << hashed.rows.size() << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(12) << selectMs << std::setw(14) << distinctMs << std::setw(14) << spilledMs << "  " << stats.describe() << "\n";
+
+        std::sort(spilled.rows.begin(), spilled.rows.end());
+        std::vector<std::string> expected = hashed.rows;
+        std::sort(expected.begin(), expected.end());
+        if (hashed.rows.size() != std::min(rows, distinct) || spilled.rows != expected) {
+            std::cout << "MISMATCH: " << hashed.rows.size() << " rows distinct in memory, " << spilled.rows.size() << " spilling\n";
+            std::filesystem::remove_all(directory);
+            return 1;
+        }
+    }
+    std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,111 @@
+// intersect.cpp
+
+// ms per intersect of two tables of an int, a float, and a chars column, hashing the smaller table against the nested loop of
+// Table::compareRow() every intersect used to run, for growing tables. table2 is a quarter of table1 and about half its rows are
+// in table1, and each table has every row twice, so rows that match are output once each. then the same with the tables swapped,
+// hashing table1. the nested loop is only run on the smaller sizes. both ways must give the same number of rows.
+// the tables are written to a temporary directory and removed after
+//
+//     make bench && ./bench/intersect.o [largest table1 rows]
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <filesystem>
+#include "../src/execute.hpp"
+
+// counts rows and drops them
+struct CountingSink : ResultSink {
+    size_t rows = 0;
+    void begin(const std::string& statement, const std::string& tables, const TableInfo& layout) override {}
+    void row(const char* rowBytes) override {
+        ++rows;
+    }
+};
+
+// rows / 2 distinct rows, each written twice, numbered from first
+void writeTable(const std::string& name, size_t rows, size_t first) {
+    TableInfo layout(name, {ColumnInfo("id", int_literal, 0), ColumnInfo("value", float_literal, 0), ColumnInfo("label", chars_literal, 12)});
+    TableWriter writer(name);
+    writer.begin("define", name, layout);
+    std::vector<char> row(layout.rowSize(), '\0');
+    for (size_t i = 0; i < rows; ++i) {
+        int id = int(first + i / 2);
+        *(int*)(row.data() + layout.columns[0].offset + 1) = id;
+        *(float*)(row.data() + layout.columns[1].offset + 1) = id * 0.25f;
+        std::string label = "row" + std::to_string(id % 1000);
+        std::fill(row.begin() + layout.columns[2].offset + 1, row.begin() + layout.columns[2].offset + 1 + 12, '\0');
+        std::copy(label.begin(), label.end(), row.begin() + layout.columns[2].offset + 1);
+        writer.row(row.data());
+    }
+    writer.end();
+}
+
+// intersect name1, name2
+std::shared_ptr<node> intersectNode(const std::string& name1, const std::string& name2) {
+    return std::make_shared<node>(bag_op, std::vector<std::shared_ptr<node>>{std::make_shared<node>(kw_intersect),
+                                  std::make_shared<node>(identifier, name1), std::make_shared<node>(identifier, name2)});
+}
+
+// the nested loop executeBagOp() ran for every intersect before hashing
+size_t nestedLoopIntersect(const std::string& name1, const std::string& name2) {
+    TableInfo t1(TABLE_DIRECTORY + name1 + FILE_EXTENSION);
+    TableInfo t2(TABLE_DIRECTORY + name2 + FILE_EXTENSION);
+    Table table1(t1);
+    Table table2(t2);
+    size_t rows = 0;
+    while (table1.nextRow()) {
+        while (table2.nextRow()) {
+            if (table1.compareRow(table2)) {
+                ++rows;
+                break;
+            }
+        }
+        table2.reset();
+    }
+    return rows;
+}
+
+int main(int argc, char** argv) {
+    size_t largest = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "femtoql_intersect_bench";
+    std::filesystem::create_directories(directory);
+    TABLE_DIRECTORY = directory.string() + "/";
+
+    std::cout << std::left << std::setw(10) << "hashed" << std::setw(12) << "t1 rows" << std::setw(12) << "t2 rows" << std::right
+              << std::setw(12) << "rows out" << std::setw(12) << "hash ms" << std::setw(16) << "nested loop ms\n";
+
+    for (bool swapped : {false, true}) {
+        for (size_t rows1 = 1000; rows1 <= largest; rows1 *= 10) {
+            size_t rows2 = rows1 / 4;
+            writeTable("big", rows1, 0);
+            writeTable("small", rows2, rows1 / 2 - rows2 / 4);
+            std::string name1 = swapped ? "small" : "big";
+            std::string name2 = swapped ? "big" : "small";
+
+            CountingSink sink;
+            auto start = std::chrono::steady_clock::now();
+            executeBagOp(intersectNode(name1, name2), sink);
+            double hashMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            std::cout << std::left << std::setw(10) << (swapped ? "table1" : "table2") << std::setw(12) << (swapped ? rows2 : rows1)
+                      << std::setw(12) << (swapped ? rows1 : rows2) << std::right << std::setw(12) << sink.rows
+                      << std::setw(12) << std::fixed << std::setprecision(1) << hashMs;
+            if (rows1 <= 10000) {
+                start = std::chrono::steady_clock::now();
+                size_t nestedRows = nestedLoopIntersect(name1, name2);
+                double nestedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                std::cout << std::setw(15) << nestedMs << "\n";
+                if (nestedRows != sink.rows) {
+                    std::cout << "MISMATCH: the nested loop intersected " << nestedRows << " rows, hashing " << sink.rows << "\n";
+                    std::filesystem::remove_all(directory);
+                    return 1;
+                }
+            }
+            else
+                std::cout << std::setw(15) << "-" << "\n";
+        }
+    }
+    std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,253 @@
+// join.cpp
+
+// ms per join of two int columns, indexing the smaller table against the nested loop over both that every join used to run, for growing tables.
+// an == join hashes, and each table2 key matches about one table1 row. a > join sorts, and table2's keys are shifted up so only the
+// top of table1 matches. the nested loop is only run on the smaller sizes. both ways must give the same number of rows.
+// then the largest == join under shrinking memory budgets, spilling to disk, and on 1 thread up to every core.
+// then a join of three tables pipelined in one pass against joining two of them into a table and joining that to the third,
+// then a join with a where clause, filtering each table before joining, against joining into a table and selecting from it,
+// and last a join of tables with a wide chars column selecting two narrow columns, against keeping every column, and against keeping every
+// column without reading the wide build side as keys and row positions when it won't fit the budget, and the rest of it back late.
+// the tables are written to a temporary directory and removed after
+//
+//     make bench && ./bench/join.o [largest table1 rows]
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <filesystem>
+#include <thread>
+#include "../src/token.hpp"
+#include "../src/tokenize.hpp"
+#include "../src/parser.hpp"
+#include "../src/execute.hpp"
+
+// counts rows and drops them
+struct CountingSink : ResultSink {
+    size_t rows = 0;
+    void begin(const std::string& statement, const std::string& tables, const TableInfo& layout) override {}
+    void row(const char* rowBytes) override {
+        ++rows;
+    }
+};
+
+// one in twenty keys is null. a padding column of that many chars follows the value, when there's padding
+void writeTable(const std::string& name, const std::string& keyName, size_t rows, size_t keys, size_t shift, int padding = 0) {
+    std::vector<ColumnInfo> columns = {ColumnInfo(keyName, int_literal, 0), ColumnInfo(name + "value", float_literal, 0)};
+    if (padding)
+        columns.push_back(ColumnInfo(name + "padding", chars_literal, padding));
+    TableInfo layout(name, columns);
+    TableWriter writer(name);
+    writer.begin("define", name, layout);
+    std::vector<char> row(layout.rowSize(), '\0');
+    for (size_t i = 0; i < rows; ++i) {
+        row[layout.columns[0].offset] = i % 20 == 0;
+        *(int*)(row.data() + layout.columns[0].offset + 1) = int((i * 2654435761u) % keys + shift);
+        *(float*)(row.data() + layout.columns[1].offset + 1) = i * 0.5f;
+        writer.row(row.data());
+    }
+    writer.end();
+}
+
+// join tables: on column1 op column2 ..., for each condition
+std::shared_ptr<node> joinNode(const std::vector<std::string>& tables, const std::vector<std::pair<std::string, std::string>>& conditions, element_type op) {
+    auto joinRoot = std::make_shared<node>(join);
+    for (auto& table : tables)
+        joinRoot->components.push_back(std::make_shared<node>(identifier, table));
+    for (auto& condition : conditions) {
+        auto onRoot = std::make_shared<node>(on_expr);
+        onRoot->components = {std::make_shared<node>(identifier, condition.first), std::make_shared<node>(op), std::make_shared<node>(identifier, condition.second)};
+        joinRoot->components.push_back(onRoot);
+    }
+    joinRoot->components.push_back(std::make_shared<node>(nullnode));
+    return joinRoot;
+}
+
+std::shared_ptr<node> joinNode(element_type op) {
+    return joinNode({"t1", "t2"}, {{"t1.k1", "t2.k2"}}, op);
+}
+
+// the nested loop executeJoin() ran for every operator before indexJoin()
+size_t nestedLoopJoin(element_type op) {
+    TableInfo t1(TABLE_DIRECTORY + "t1" + FILE_EXTENSION);
+    TableInfo t2(TABLE_DIRECTORY + "t2" + FILE_EXTENSION);
+    Table table1(t1);
+    Table table2(t2);
+    size_t rows = 0;
+    while (table1.nextRow()) {
+        while (table2.nextRow())
+            rows += table1.compareCell("k1", op, table2, "k2");
+        table2.reset();
+    }
+    return rows;
+}
+
+int main(int argc, char** argv) {
+    size_t largest = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "femtoql_join_bench";
+    std::filesystem::create_directories(directory);
+    TABLE_DIRECTORY = directory.string() + "/";
+
+    std::cout << std::left << std::setw(6) << "on" << std::setw(12) << "t1 rows" << std::setw(12) << "t2 rows" << std::right
+              << std::setw(14) << "joined rows" << std::setw(12) << "index ms" << std::setw(16) << "nested loop ms\n";
+
+    for (element_type op : {op_equals, op_greater_than}) {
+        for (size_t rows1 = 1000; rows1 <= largest; rows1 *= 10) {
+            size_t rows2 = rows1 / 4;
+            writeTable("t1", "k1", rows1, rows1, 0);
+            writeTable("t2", "k2", rows2, rows1, op == op_equals ? 0 : rows1 - rows1 / 100);
+
+            CountingSink sink;
+            auto start = std::chrono::steady_clock::now();
+            executeJoin(joinNode(op), sink);
+            double indexMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            std::cout << std::left << std::setw(6) << (op == op_equals ? "==" : ">") << std::setw(12) << rows1 << std::setw(12) << rows2 << std::right
+                      << std::setw(14) << sink.rows << std::setw(12) << std::fixed << std::setprecision(1) << indexMs;
+            if (rows1 <= 10000) {
+                start = std::chrono::steady_clock::now();
+                size_t nestedRows = nestedLoopJoin(op);
+                double nestedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                std::cout << std::setw(15) << nestedMs << "\n";
+                if (nestedRows != sink.rows) {
+                    std::cout << "MISMATCH: the nested loop joined " << nestedRows << " rows, the index join " << sink.rows << "\n";
+                    std::filesystem::remove_all(directory);
+                    return 1;
+                }
+            }
+            else
+                std::cout << std::setw(15) << "-" << "\n";
+        }
+    }
+
+    // the largest == join again, with memory budgets small enough to make it spill
+    writeTable("t1", "k1", largest, largest, 0);
+    writeTable("t2", "k2", largest / 4, largest, 0);
+    size_t inMemoryBudget = JOIN_MEMORY_BUDGET;
+    unsigned int allThreads = JOIN_THREADS;
+    JOIN_THREADS = 1;
+    CountingSink inMemory;
+    executeJoin(joinNode(op_equals), inMemory);
+    JOIN_THREADS = allThreads;
+    std::cout << "\n" << std::left << std::setw(12) << "budget MiB" << std::right << std::setw(12) << "ms" << "  spilled\n";
+    for (size_t budget : {64, 16, 4, 1}) {
+        JOIN_MEMORY_BUDGET = budget << 20;
+        CountingSink sink;
+        JoinStats stats;
+        auto start = std::chrono::steady_clock::now();
+        executeJoin(joinNode(op_equals), sink, &stats);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << std::left << std::setw(12) << budget << std::right << std::setw(12) << ms << "  " << stats.describe() << "\n";
+        if (sink.rows != inMemory.rows) {
+            std::cout << "MISMATCH: the in memory join joined " << inMemory.rows << " rows, the spilling join " << sink.rows << "\n";
+            std::filesystem::remove_all(directory);
+            return 1;
+        }
+    }
+
+    // and on 1 thread up to every core, with the budget back where it was
+    JOIN_MEMORY_BUDGET = inMemoryBudget;
+    unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "\n" << std::left << std::setw(12) << "threads" << std::right << std::setw(12) << "ms" << std::setw(10) << "speedup\n";
+    double oneThreadMs = 0;
+    std::vector<unsigned int> threadCounts;
+    for (unsigned int threads = 1; threads < cores; threads *= 2)
+        threadCounts.push_back(threads);
+    threadCounts.push_back(cores);
+    for (unsigned int threads : threadCounts) {
+        JOIN_THREADS = threads;
+        CountingSink sink;
+        auto start = std::chrono::steady_clock::now();
+        executeJoin(joinNode(op_equals), sink);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (threads == 1)
+            oneThreadMs = ms;
+        std::cout << std::left << std::setw(12) << threads << std::right << std::setw(12) << ms << std::setw(8) << oneThreadMs / ms << "x\n";
+        if (sink.rows != inMemory.rows) {
+            std::cout << "MISMATCH: the join on one thread joined " << inMemory.rows << " rows, on " << threads << " threads " << sink.rows << "\n";
+            std::filesystem::remove_all(directory);
+            return 1;
+        }
+    }
+
+    // three tables, t3 a sixteenth of t1, pipelined and with t1 and t2 joined into a table first
+    writeTable("t3", "k3", largest / 16, largest, 0);
+    std::cout << "\n" << std::left << std::setw(16) << "3 tables" << std::right << std::setw(14) << "joined rows" << std::setw(12) << "ms\n";
+    CountingSink pipelined;
+    auto start = std::chrono::steady_clock::now();
+    executeJoin(joinNode({"t1", "t2", "t3"}, {{"t1.k1", "t2.k2"}, {"t2.k2", "t3.k3"}}, op_equals), pipelined);
+    double pipelinedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << std::left << std::setw(16) << "pipelined" << std::right << std::setw(14) << pipelined.rows << std::setw(11) << pipelinedMs << "\n";
+
+    CountingSink materialized;
+    start = std::chrono::steady_clock::now();
+    {
+        TableWriter writer("t12");
+        executeJoin(joinNode(op_equals), writer);
+    }
+    executeJoin(joinNode({"t12", "t3"}, {{"t12.k2", "t3.k3"}}, op_equals), materialized);
+    double materializedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << std::left << std::setw(16) << "materialized" << std::right << std::setw(14) << materialized.rows << std::setw(11) << materializedMs << "\n";
+    if (pipelined.rows != materialized.rows) {
+        std::cout << "MISMATCH: the pipelined join joined " << pipelined.rows << " rows, the materialized one " << materialized.rows << "\n";
+        std::filesystem::remove_all(directory);
+        return 1;
+    }
+
+    // a where clause with a term on each table and one on both, pushed below the join against run on the materialized join
+    std::string where = " where t1value < " + std::to_string(largest / 16) + ".0 && t2value > 100.0 && t1value <= t2value";
+    std::cout << "\n" << std::left << std::setw(16) << "where" << std::right << std::setw(14) << "joined rows" << std::setw(12) << "ms\n";
+    Parameters parameters;
+    CountingSink pushedDown;
+    start = std::chrono::steady_clock::now();
+    JoinPlan(Parser(tokenize("join t1, t2: on t1.k1 == t2.k2" + where)).parse()->components[0], parameters).run(pushedDown);
+    double pushedDownMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << std::left << std::setw(16) << "pushed down" << std::right << std::setw(14) << pushedDown.rows << std::setw(11) << pushedDownMs << "\n";
+
+    CountingSink selected;
+    start = std::chrono::steady_clock::now();
+    {
+        TableWriter writer("t12");
+        executeJoin(joinNode(op_equals), writer);
+    }
+    SelectionPlan(Parser(tokenize("select from t12: *" + where)).parse()->components[0], parameters).run(selected);
+    double selectedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << std::left << std::setw(16) << "materialized" << std::right << std::setw(14) << selected.rows << std::setw(11) << selectedMs << "\n";
+    if (pushedDown.rows != selected.rows) {
+        std::cout << "MISMATCH: the join with a where clause joined " << pushedDown.rows << " rows, selecting from the join " << selected.rows << "\n";
+        std::filesystem::remove_all(directory);
+        return 1;
+    }
+
+    // 200 chars of padding in each table, selecting two columns against every column, all in memory and on a budget every column won't fit
+    writeTable("t1", "k1", largest, largest, 0, 200);
+    writeTable("t2", "k2", largest / 4, largest, 0, 200);
+    std::cout << "\n" << std::left << std::setw(16) << "columns" << std::setw(12) << "budget MiB" << std::right << std::setw(14) << "joined rows"
+              << std::setw(12) << "ms" << "  spilled, read back late\n";
+    size_t lateBytes = LATE_MATERIALIZATION_MIN_BYTES;
+    for (size_t budget : {inMemoryBudget >> 20, size_t(16)}) {
+        JOIN_MEMORY_BUDGET = budget << 20;
+        size_t rows[3];
+        for (int columns = 0; columns < 3; ++columns) {
+            LATE_MATERIALIZATION_MIN_BYTES = columns == 1 ? SIZE_MAX : lateBytes;
+            CountingSink sink;
+            start = std::chrono::steady_clock::now();
+            JoinPlan plan(Parser(tokenize(std::string("join t1, t2: on t1.k1 == t2.k2") + (columns == 2 ? " select t1.k1, t2.t2value" : ""))).parse()->components[0], parameters);
+            plan.run(sink);
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            rows[columns] = sink.rows;
+            std::cout << std::left << std::setw(16) << (columns == 0 ? "every" : columns == 1 ? "every, not late" : "selected") << std::setw(12) << budget
+                      << std::right << std::setw(14) << sink.rows << std::setw(12) << ms << "  " << plan.joinStats.describe() << "\n";
+        }
+        if (rows[0] != rows[2] || rows[1] != rows[2]) {
+            std::cout << "MISMATCH: the join of every column joined " << rows[0] << " rows, " << rows[1] << " without reading rows back late, selecting two "
+                      << rows[2] << "\n";
+            std::filesystem::remove_all(directory);
+            return 1;
+        }
+    }
+    LATE_MATERIALIZATION_MIN_BYTES = lateBytes;
+    JOIN_MEMORY_BUDGET = inMemoryBudget;
+    std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,104 @@
+// kernels.cpp
+
+// rows per cycle of each int and float comparison kernel in Kernels.hpp, scalar, sse2, and avx2, over blocks of BATCH_SIZE rows
+// the same few blocks are compared over and over so they stay in cache and the kernels, not memory, are what's timed
+// cycles are timestamp counter ticks. every kernel set has to produce the same bitmask as the scalar one
+//
+//     make bench && ./bench/kernels.o [rows]
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <x86intrin.h>
+#include "../src/TableInfo.hpp"
+#include "../src/Batch.hpp"
+#include "../src/Kernels.hpp"
+
+// one in ten values is null, one in a hundred floats is NaN
+TableInfo benchLayout() {
+    return TableInfo("bench", {ColumnInfo("id", int_literal, 0), ColumnInfo("score", float_literal, 0), ColumnInfo("name", chars_literal, 16)});
+}
+
+std::vector<char> benchRows(const TableInfo& layout, size_t rows) {
+    size_t rowSize = layout.rowSize();
+    std::vector<char> block(rows * rowSize, '\0');
+    for (size_t i = 0; i < rows; ++i) {
+        char* row = block.data() + i * rowSize;
+        int value = (i * 7919) % 1000;
+        for (const ColumnInfo& column : layout.columns) {
+            char* cell = row + column.offset;
+            if ((i + column.offset) % 10 == 0) {
+                *cell = 1;
+                continue;
+            }
+            if (column.type == int_literal)
+                std::memcpy(cell + 1, &value, sizeof(int));
+            else if (column.type == float_literal) {
+                float f = i % 100 == 0 ? NAN : value * 0.5f;
+                std::memcpy(cell + 1, &f, sizeof(float));
+            }
+        }
+    }
+    return block;
+}
+
+int main(int argc, char** argv) {
+    size_t rows = argc > 1 ? std::stoul(argv[1]) : 4000000;
+    rows -= rows % BATCH_SIZE;
+    const size_t blocks = 16;
+
+    TableInfo layout = benchLayout();
+    size_t rowSize = layout.rowSize();
+    std::vector<char> allRows = benchRows(layout, blocks * BATCH_SIZE);
+    int intOffset = layout.columns[0].offset;
+    int floatOffset = layout.columns[1].offset;
+
+    std::vector<KernelSet> sets = {KernelSet::Scalar};
+    if (__builtin_cpu_supports("sse2"))
+        sets.push_back(KernelSet::Sse2);
+    if (__builtin_cpu_supports("avx2"))
+        sets.push_back(KernelSet::Avx2);
+
+    const std::pair<element_type, const char*> ops[] = {{op_equals, "=="}, {op_not_equals, "!="}, {op_less_than, "<"},
+                                                         {op_less_than_equals, "<="}, {op_greater_than, ">"}, {op_greater_than_equals, ">="}};
+
+    std::cout << rows << " rows of " << rowSize << " bytes in " << blocks << " blocks, best kernel set " << kernelSetName(bestKernelSet()) << "\n";
+    std::cout << std::left << std::setw(14) << "filter";
+    for (KernelSet set : sets)
+        std::cout << std::right << std::setw(10) << kernelSetName(set);
+    std::cout << "   rows/cycle\n";
+
+    size_t words = bitmaskWords(BATCH_SIZE);
+    for (bool isFloat : {false, true}) {
+        for (auto [op, opName] : ops) {
+            std::cout << std::left << std::setw(14) << (std::string(isFloat ? "float " : "int ") + opName + " 250");
+
+            std::vector<uint64_t> expected;
+            for (KernelSet set : sets) {
+                std::vector<uint64_t> bits(blocks * words);
+                unsigned long long start = __rdtsc();
+                for (size_t first = 0; first < rows; first += BATCH_SIZE) {
+                    size_t b = first / BATCH_SIZE % blocks;
+                    const char* block = allRows.data() + b * BATCH_SIZE * rowSize;
+                    uint64_t* blockBits = bits.data() + b * words;
+                    if (isFloat)
+                        compareFloats(block, rowSize, BATCH_SIZE, floatOffset, op, 250.0f, blockBits, set);
+                    else
+                        compareInts(block, rowSize, BATCH_SIZE, intOffset, op, 250, blockBits, set);
+                }
+                unsigned long long cycles = __rdtsc() - start;
+                std::cout << std::right << std::setw(10) << std::fixed << std::setprecision(3) << double(rows) / cycles;
+
+                if (expected.empty())
+                    expected = bits;
+                else if (bits != expected) {
+                    std::cout << "\nMISMATCH: " << kernelSetName(set) << " disagrees with scalar\n";
+                    return 1;
+                }
+            }
+            std::cout << '\n';
+        }
+    }
+}
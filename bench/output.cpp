@@ -0,0 +1,119 @@
+// output.cpp
+
+// rows/sec of each output format, writing to a stream that throws the bytes away
+// "pretty (setw)" is the old way of printing a row, cellToString() and std::setw on an ostream, for comparison
+//
+//     make bench && ./bench/output.o [rows]
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <string>
+#include "../src/TableInfo.hpp"
+#include "../src/Table.hpp"
+#include "../src/Batch.hpp"
+#include "../src/Output.hpp"
+
+// counts bytes and drops them
+struct NullBuffer : std::streambuf {
+    size_t bytes = 0;
+
+    int overflow(int c) override {
+        ++bytes;
+        return c;
+    }
+
+    std::streamsize xsputn(const char* s, std::streamsize n) override {
+        bytes += n;
+        return n;
+    }
+};
+
+// one in ten values is null
+TableInfo benchLayout() {
+    return TableInfo("bench", {ColumnInfo("id", int_literal, 0), ColumnInfo("score", float_literal, 0),
+                               ColumnInfo("name", chars_literal, 16), ColumnInfo("ok", bool_literal, 0)});
+}
+
+std::vector<char> benchRow(const TableInfo& layout, int i) {
+    std::vector<char> row(layout.rowSize(), '\0');
+    for (size_t c = 0; c < layout.columns.size(); ++c) {
+        const ColumnInfo& column = layout.columns[c];
+        char* cell = row.data() + column.offset;
+        if ((i + c) % 10 == 0) {
+            *cell = 1;
+            continue;
+        }
+        switch (column.type) {
+            case int_literal: *(int*)(cell + 1) = i * 7919; break;
+            case float_literal: *(float*)(cell + 1) = i * 0.37f; break;
+            case bool_literal: *(cell + 1) = i % 3 == 0; break;
+            case chars_literal: {
+                std::string name = "name" + std::to_string(i % 100000);
+                std::copy(name.begin(), name.end(), cell + 1);
+                break;
+            }
+        }
+    }
+    return row;
+}
+
+// collects the batches so the formats can be timed on their own
+struct BatchCollector : BatchConsumer {
+    std::vector<Batch> batches;
+    void begin(const std::string& statement, const std::string& tables, const TableInfo& layout) override {}
+    void consume(const Batch& batch) override {
+        batches.push_back(batch);
+    }
+};
+
+void report(const std::string& name, size_t rows, std::chrono::steady_clock::duration elapsed, size_t bytes) {
+    double seconds = std::chrono::duration<double>(elapsed).count();
+    std::cout << std::left << std::setw(16) << name << std::right
+              << std::setw(14) << std::fixed << std::setprecision(0) << rows / seconds << " rows/s"
+              << std::setw(10) << std::setprecision(1) << bytes / seconds / (1 << 20) << " MiB/s\n";
+}
+
+int main(int argc, char** argv) {
+    size_t rows = argc > 1 ? std::stoul(argv[1]) : 2000000;
+
+    TableInfo layout = benchLayout();
+    std::vector<std::vector<char>> distinctRows;
+    for (int i = 0; i < 4096; ++i)
+        distinctRows.push_back(benchRow(layout, i));
+
+    BatchCollector collector;
+    Batcher batcher(collector);
+    batcher.begin("select from", "bench", layout);
+    for (size_t i = 0; i < rows; ++i)
+        batcher.row(distinctRows[i % distinctRows.size()].data());
+    batcher.end();
+
+    std::cout << rows << " rows of int, float, chars 16, bool\n";
+
+    for (std::string format : {"pretty", "csv", "tsv", "binary"}) {
+        NullBuffer discard;
+        std::ostream out(&discard);
+        auto start = std::chrono::steady_clock::now();
+        {
+            FormattedOutput output(out, format);
+            output.begin("select from", "bench", layout);
+            for (const Batch& batch : collector.batches)
+                output.consume(batch);
+            output.end();
+        }
+        report(format, rows, std::chrono::steady_clock::now() - start, discard.bytes);
+    }
+
+    NullBuffer discard;
+    std::ostream out(&discard);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < rows; ++i) {
+        const char* row = distinctRows[i % distinctRows.size()].data();
+        for (const ColumnInfo& column : layout.columns)
+            out << std::right << std::setw(column.outputWidth) << cellToString(row + column.offset, column) << ' ';
+        out << '\n';
+    }
+    report("pretty (setw)", rows, std::chrono::steady_clock::now() - start, discard.bytes);
+}
@@ -0,0 +1,156 @@
+// predicate.cpp
+
+// rows/sec of where clauses evaluated by the tree convert() builds, and by the program compileProgram() builds
+// a row at a time and a block at a time, over the same rows
+// all three must pick the same rows, so the match counts are checked against each other
+// the rows are kept in memory, the tree reads each one by pointing its Table's currentRow at it
+// the tree is built from the where clause as written, the program from it simplify()ed, so the counts check simplify() too
+//
+//     make bench && ./bench/predicate.o [rows]
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <filesystem>
+#include "../src/token.hpp"
+#include "../src/tokenize.hpp"
+#include "../src/parser.hpp"
+#include "../src/execute.hpp"
+#include "convert.hpp"
+
+struct NullSink : ResultSink {
+    void begin(const std::string& statement, const std::string& tables, const TableInfo& layout) override {}
+    void row(const char* rowBytes) override {}
+};
+
+std::shared_ptr<node> parseScript(const std::string& script) {
+    Parser p(tokenize(script));
+    return p.parse();
+}
+
+// one in ten values is null
+TableInfo benchLayout() {
+    return TableInfo("bench", {ColumnInfo("id", int_literal, 0), ColumnInfo("id2", int_literal, 0), ColumnInfo("score", float_literal, 0),
+                               ColumnInfo("name", chars_literal, 16), ColumnInfo("ok", bool_literal, 0)});
+}
+
+std::vector<char> benchRow(const TableInfo& layout, int i) {
+    std::vector<char> row(layout.rowSize(), '\0');
+    for (size_t c = 0; c < layout.columns.size(); ++c) {
+        const ColumnInfo& column = layout.columns[c];
+        char* cell = row.data() + column.offset;
+        if ((i + c) % 10 == 0) {
+            *cell = 1;
+            continue;
+        }
+        int value = (i * 7919 + c * 104729) % 1000000;
+        switch (column.type) {
+            case int_literal: *(int*)(cell + 1) = value; break;
+            case float_literal: *(float*)(cell + 1) = value * 0.001f; break;
+            case bool_literal: *(cell + 1) = value % 3 == 0; break;
+            case chars_literal: {
+                std::string name = "name" + std::to_string(value % 1000);
+                std::copy(name.begin(), name.end(), cell + 1);
+                break;
+            }
+        }
+    }
+    return row;
+}
+
+double rowsPerSecond(size_t rows, std::chrono::steady_clock::duration elapsed) {
+    return rows / std::chrono::duration<double>(elapsed).count();
+}
+
+int main(int argc, char** argv) {
+    size_t rows = argc > 1 ? std::stoul(argv[1]) : 2000000;
+
+    // the rhs of in, any, and all has to be a table on disk
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "femtoql-bench";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    TABLE_DIRECTORY = directory.string() + "/";
+
+    std::string script = "define r: k(int), f(float), s(chars 16)\n";
+    for (int i = 0; i < 200; ++i)
+        script += "insert into r: k(" + std::to_string(i * 4999) + "), f(" + std::to_string(i * 2.5) + "), s(\"name" + std::to_string(i * 3) + "\")\n";
+    NullSink discard;
+    execute(parseScript(script), discard);
+
+    TableInfo layout = benchLayout();
+    std::vector<char> allRows;
+    for (size_t i = 0; i < rows; ++i) {
+        std::vector<char> row = benchRow(layout, i);
+        allRows.insert(allRows.end(), row.begin(), row.end());
+    }
+    size_t rowSize = layout.rowSize();
+
+    std::vector<std::string> predicates = {
+        "id > 500000",
+        "score <= 100.5 && name != \"name7\"",
+        "id < 1000 || ok == true",
+        "!(id >= 100 && score < 50.0) || name == null",
+        "id == id2 || id < id2",
+        "(id > 10 && id < 900000 && ok != false) || (name >= \"name5\" && score != 0.0)",
+        "id in r.k",
+        "name < any r.s",
+        "score > all r.f",
+        "!(id < 1000) && id <= 500000 && id > 10 && !(!(id != 7))",
+        "!(score >= 100.0 || name == null) && score != 50.0",
+        "id < 1000 || id < 20000 || id == null",
+        "id < 5000 && (id > 10000 || ok == true) && id > 6000",
+    };
+
+    std::cout << rows << " rows\n";
+    std::cout << std::left << std::setw(80) << "where" << std::right << std::setw(14) << "tree rows/s" << std::setw(16) << "program rows/s" << std::setw(14) << "block rows/s" << std::setw(10) << "speedup\n";
+
+    for (const std::string& predicate : predicates) {
+        std::shared_ptr<node> where = parseScript("select from bench: * where " + predicate)->components[0]->components[3]->components[0];
+        Parameters parameters;
+
+        Table table(layout);
+        char* ownRow = table.currentRow;
+        std::shared_ptr<EvaluationNode> tree = convert(where, table, layout, parameters);
+        PredicateProgram program;
+        compileProgram(where, layout, program, parameters);
+
+        size_t treeMatches = 0;
+        auto start = std::chrono::steady_clock::now();
+        tree->open();
+        for (size_t i = 0; i < rows; ++i) {
+            table.currentRow = allRows.data() + i * rowSize;
+            treeMatches += tree->evaluate();
+        }
+        double treeRate = rowsPerSecond(rows, std::chrono::steady_clock::now() - start);
+        table.currentRow = ownRow;
+
+        size_t programMatches = 0;
+        start = std::chrono::steady_clock::now();
+        program.open();
+        for (size_t i = 0; i < rows; ++i)
+            programMatches += program.evaluate(allRows.data() + i * rowSize);
+        double programRate = rowsPerSecond(rows, std::chrono::steady_clock::now() - start);
+
+        size_t blockMatches = 0;
+        std::vector<uint16_t> selection;
+        start = std::chrono::steady_clock::now();
+        program.open();
+        for (size_t first = 0; first < rows; first += BATCH_SIZE) {
+            program.select(allRows.data() + first * rowSize, rowSize, std::min(BATCH_SIZE, rows - first), selection);
+            blockMatches += selection.size();
+        }
+        double blockRate = rowsPerSecond(rows, std::chrono::steady_clock::now() - start);
+
+        std::cout << std::left << std::setw(80) << predicate << std::right << std::fixed << std::setprecision(0)
+                  << std::setw(14) << treeRate << std::setw(16) << programRate << std::setw(14) << blockRate
+                  << std::setw(9) << std::setprecision(1) << std::max(programRate, blockRate) / treeRate << "x\n";
+        if (treeMatches != programMatches || treeMatches != blockMatches) {
+            std::cout << "MISMATCH: tree matched " << treeMatches << " rows, program matched " << programMatches << ", blocks matched " << blockMatches << "\n";
+            return 1;
+        }
+    }
+
+    std::filesystem::remove_all(directory);
+}
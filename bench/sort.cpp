@@ -0,0 +1,114 @@
+// sort.cpp
+
+// ms per select ordered by an int, a float, and a chars column of a table in scattered order, against the plain select it sorts,
+// first in memory and then with SORT_MEMORY_BUDGET cut to a few thousand rows' worth, so the rows are sorted in runs spilled to
+// temporary files and merged, with the runs and merge passes that took. both ways must give the same rows in the same order,
+// each no greater than the next. the table is written to a temporary directory and removed after
+//
+//     make bench && ./bench/sort.o [rows]
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <filesystem>
+#include "../src/token.hpp"
+#include "../src/tokenize.hpp"
+#include "../src/parser.hpp"
+#include "../src/execute.hpp"
+
+// the rows, in the order they came
+struct CollectingSink : ResultSink {
+    unsigned int rowSize = 0;
+    std::vector<std::string> rows;
+    void begin(const std::string& statement, const std::string& tables, const TableInfo& layout) override {
+        rowSize = layout.rowSize();
+        rows.clear();
+    }
+    void row(const char* rowBytes) override {
+        rows.emplace_back(rowBytes, rowSize);
+    }
+};
+
+// rows rows in scattered order, every 100th value null
+void writeTable(const std::string& name, size_t rows) {
+    TableInfo layout(name, {ColumnInfo("id", int_literal, 0), ColumnInfo("value", float_literal, 0), ColumnInfo("label", chars_literal, 12)});
+    TableWriter writer(name);
+    writer.begin("define", name, layout);
+    std::vector<char> row(layout.rowSize(), '\0');
+    for (size_t i = 0; i < rows; ++i) {
+        unsigned int scattered = unsigned(i * 2654435761u);
+        int id = int(scattered % 2000001) - 1000000;
+        row[layout.columns[0].offset] = i % 100 == 0;
+        *(int*)(row.data() + layout.columns[0].offset + 1) = id;
+        row[layout.columns[1].offset] = i % 100 == 1;
+        *(float*)(row.data() + layout.columns[1].offset + 1) = id * 0.25f;
+        row[layout.columns[2].offset] = i % 100 == 2;
+        std::string label = "row" + std::to_string(scattered % 100000);
+        std::fill(row.begin() + layout.columns[2].offset + 1, row.begin() + layout.columns[2].offset + 1 + 12, '\0');
+        std::copy(label.begin(), label.end(), row.begin() + layout.columns[2].offset + 1);
+        writer.row(row.data());
+    }
+    writer.end();
+}
+
+// ms to run the selection into sink
+double timeSelection(const std::string& selection, CollectingSink& sink, std::string* sortStatistics = nullptr) {
+    Parameters parameters;
+    SelectionPlan plan(Parser(tokenize(selection)).parse()->components[0], parameters);
+    auto start = std::chrono::steady_clock::now();
+    plan.run(sink);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (sortStatistics)
+        *sortStatistics = plan.sortStatistics();
+    return ms;
+}
+
+// whether the rows are in order of the column, nulls last
+bool ordered(const std::vector<std::string>& rows, const ColumnInfo& column) {
+    std::vector<char> previous(column.bytesNeeded), key(column.bytesNeeded);
+    for (size_t i = 0; i < rows.size(); ++i) {
+        sortKey(rows[i].data() + column.offset, column, false, key.data());
+        if (i != 0 && std::memcmp(previous.data(), key.data(), key.size()) > 0)
+            return false;
+        previous.swap(key);
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    size_t rows = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "femtoql_sort_bench";
+    std::filesystem::create_directories(directory);
+    TABLE_DIRECTORY = directory.string() + "/";
+    SPILL_DIRECTORY = directory.string();
+    size_t budget = SORT_MEMORY_BUDGET;
+
+    writeTable("bench", rows);
+    TableInfo layout(TABLE_DIRECTORY + "bench" + FILE_EXTENSION);
+    CollectingSink all;
+    double selectMs = timeSelection("select from bench: *", all);
+    std::cout << rows << " rows, select " << std::fixed << std::setprecision(1) << selectMs << " ms\n\n";
+
+    std::cout << std::left << std::setw(10) << "order" << std::right << std::setw(14) << "in memory ms" << std::setw(14) << "spilling ms" << "  spilled\n";
+    for (const std::string& column : {"id", "value", "label"}) {
+        CollectingSink inMemory, spilled;
+        double inMemoryMs = timeSelection("select from bench: * order " + column + " asc", inMemory);
+        SORT_MEMORY_BUDGET = 4096 * (layout.rowSize() + layout[column]->bytesNeeded + sizeof(SortSink::Position));
+        std::string statistics;
+        double spilledMs = timeSelection("select from bench: * order " + column + " asc", spilled, &statistics);
+        SORT_MEMORY_BUDGET = budget;
+
+        std::cout << std::left << std::setw(10) << column << std::right << std::setw(14) << inMemoryMs << std::setw(14) << spilledMs
+                  << "  " << statistics << "\n";
+
+        if (inMemory.rows.size() != all.rows.size() || spilled.rows != inMemory.rows || !ordered(inMemory.rows, *layout[column])) {
+            std::cout << "MISMATCH: " << inMemory.rows.size() << " rows sorted in memory, " << spilled.rows.size() << " spilling\n";
+            std::filesystem::remove_all(directory);
+            return 1;
+        }
+    }
+    std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,154 @@
+// Batch.hpp
+
+#ifndef BATCH
+#define BATCH
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include "TableInfo.hpp"
+#include "Table.hpp"
+#include "ResultSink.hpp"
+
+// number of rows in a full batch
+const size_t BATCH_SIZE = 1024;
+
+// one column of a batch
+// values are contiguous and typed: one int, float, or bool per row, or charsLength bytes per row padded with '\0'
+// only the vector for the column's type is used. a null row has nulls[row] == 1 and a zeroed value
+struct ColumnVector {
+    ColumnInfo info;
+    std::vector<uint8_t> nulls;
+    std::vector<int> ints;
+    std::vector<float> floats;
+    std::vector<uint8_t> bools;
+    std::vector<char> chars;
+
+    ColumnVector(const ColumnInfo& info) : info(info) {
+        nulls.reserve(BATCH_SIZE);
+        switch (info.type) {
+            case int_literal: ints.reserve(BATCH_SIZE); break;
+            case float_literal: floats.reserve(BATCH_SIZE); break;
+            case bool_literal: bools.reserve(BATCH_SIZE); break;
+            case chars_literal: chars.reserve(BATCH_SIZE * info.charsLength); break;
+        }
+    }
+
+    // append a cell, given a pointer to its null byte
+    void append(const char* cell) {
+        bool isNull = *(uint8_t*)cell;
+        nulls.push_back(isNull);
+
+        switch (info.type) {
+            case int_literal: {
+                int value = 0;
+                if (!isNull)
+                    std::memcpy(&value, cell + 1, sizeof(value));
+                ints.push_back(value);
+                break;
+            }
+            case float_literal: {
+                float value = 0;
+                if (!isNull)
+                    std::memcpy(&value, cell + 1, sizeof(value));
+                floats.push_back(value);
+                break;
+            }
+            case bool_literal:
+                bools.push_back(isNull ? 0 : *(uint8_t*)(cell + 1) != 0);
+                break;
+            case chars_literal:
+                if (isNull)
+                    chars.insert(chars.end(), info.charsLength, '\0');
+                else
+                    chars.insert(chars.end(), cell + 1, cell + 1 + info.charsLength);
+                break;
+        }
+    }
+
+    // a row's chars value, without padding
+    std::string getChars(size_t row) const {
+        const char* begin = chars.data() + row * info.charsLength;
+        return std::string(begin, std::find(begin, begin + info.charsLength, '\0'));
+    }
+
+    void clear() {
+        nulls.clear();
+        ints.clear();
+        floats.clear();
+        bools.clear();
+        chars.clear();
+    }
+};
+
+// up to BATCH_SIZE rows of a result, stored column by column
+struct Batch {
+    std::vector<ColumnVector> columns;
+    size_t size = 0;
+
+    void clear() {
+        for (ColumnVector& column : columns)
+            column.clear();
+        size = 0;
+    }
+};
+
+// takes the result of a statement a batch at a time
+struct BatchConsumer {
+    virtual ~BatchConsumer() = default;
+
+    // called once before any batches, e.g. begin("select from", "t", layout)
+    virtual void begin(const std::string& statement, const std::string& tables, const TableInfo& layout) = 0;
+
+    // never called with an empty batch
+    virtual void consume(const Batch& batch) = 0;
+
+    // called once after the last batch
+    virtual void end() {}
+
+    // see ResultSink::setFormat()
+    virtual void setFormat(const std::string& format) {}
+};
+
+// collects the rows the executor produces into batches, handing each one to consumer as soon as it is full
+// the executor waits for consume() to return, so a slow consumer slows the scan down instead of rows piling up
+struct Batcher : ResultSink {
+    BatchConsumer& consumer;
+    Batch batch;
+
+    Batcher(BatchConsumer& consumer) : consumer(consumer) {}
+
+    void begin(const std::string& statement, const std::string& tables, const TableInfo& layout) override {
+        batch.columns.clear();
+        for (const ColumnInfo& column : layout.columns)
+            batch.columns.push_back(ColumnVector(column));
+        batch.size = 0;
+
+        consumer.begin(statement, tables, layout);
+    }
+
+    void row(const char* rowBytes) override {
+        for (ColumnVector& column : batch.columns)
+            column.append(rowBytes + column.info.offset);
+
+        if (++batch.size == BATCH_SIZE) {
+            consumer.consume(batch);
+            batch.clear();
+        }
+    }
+
+    void end() override {
+        if (batch.size != 0)
+            consumer.consume(batch);
+        batch.clear();
+
+        consumer.end();
+    }
+
+    void setFormat(const std::string& format) override {
+        consumer.setFormat(format);
+    }
+};
+
+#endif
@@ -0,0 +1,96 @@
+// BatchQueue.hpp
+
+#ifndef BATCHQUEUE
+#define BATCHQUEUE
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include "TableInfo.hpp"
+#include "Batch.hpp"
+
+// hands batches from a thread running the executor to a thread reading them
+// at most capacity batches wait in the queue. once it is full the executor blocks in consume() until the reader catches up
+struct BatchQueue : BatchConsumer {
+
+    // thrown on the executor's thread once the reader has gone away, to stop the scan early
+    struct Cancelled {};
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<Batch> batches;
+    size_t capacity;
+
+    TableInfo layout;
+    bool begun = false;
+    bool finished = false;
+    bool cancelled = false;
+    bool unbounded = false;
+    std::exception_ptr error;
+
+    BatchQueue(size_t capacity = 4) : capacity(capacity) {}
+
+    // EXECUTOR SIDE
+
+    void begin(const std::string& statement, const std::string& tables, const TableInfo& layout) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->layout = layout;
+        begun = true;
+        changed.notify_all();
+    }
+
+    void consume(const Batch& batch) override {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [this]{ return batches.size() < capacity || unbounded || cancelled; });
+        if (cancelled)
+            throw Cancelled();
+        batches.push_back(batch);
+        changed.notify_all();
+    }
+
+    // called when the executor returns, or with what it threw
+    void finish(std::exception_ptr thrown) {
+        std::lock_guard<std::mutex> lock(mutex);
+        finished = true;
+        error = thrown;
+        changed.notify_all();
+    }
+
+    // READER SIDE
+
+    // wait until the layout is known. false if the executor finished without producing one
+    bool waitForBegin() {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [this]{ return begun || finished; });
+        return begun;
+    }
+
+    // take the next batch, false once there are no more
+    bool pop(Batch& batch) {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [this]{ return !batches.empty() || finished; });
+        if (batches.empty())
+            return false;
+        batch = std::move(batches.front());
+        batches.pop_front();
+        changed.notify_all();
+        return true;
+    }
+
+    // stop blocking the executor, letting it run to the end while the rest of its batches pile up
+    void drain() {
+        std::lock_guard<std::mutex> lock(mutex);
+        unbounded = true;
+        changed.notify_all();
+    }
+
+    // make the executor stop at its next batch
+    void cancel() {
+        std::lock_guard<std::mutex> lock(mutex);
+        cancelled = true;
+        changed.notify_all();
+    }
+};
+
+#endif
@@ -0,0 +1,81 @@
+// BloomFilter.hpp
+
+#ifndef BLOOMFILTER
+#define BLOOMFILTER
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// a blocked bloom filter, kept next to a large set of values so most values that aren't in it are ruled out without probing it
+// each value sets one bit in each of the 8 words of a single 64 byte block, so checking a value reads one cache line,
+// and at 16 bits per value the whole filter is a small fraction of the set's size
+struct BloomFilter {
+    static const size_t BITS_PER_VALUE = 16;
+    static const size_t WORDS_PER_BLOCK = 8;
+
+    std::vector<uint64_t> words;
+    uint64_t blockMask = 0;
+
+    bool enabled() const {
+        return !words.empty();
+    }
+
+    // room for values values, in a power of two number of blocks
+    void reserve(size_t values) {
+        size_t blocks = 1;
+        while (blocks * WORDS_PER_BLOCK * 64 < values * BITS_PER_VALUE)
+            blocks *= 2;
+        words.assign(blocks * WORDS_PER_BLOCK, 0);
+        blockMask = blocks - 1;
+    }
+
+    // spreads std::hash, which is the value itself for ints, over all 64 bits. the murmur3 finalizer
+    static uint64_t mix(uint64_t hash) {
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 33;
+        hash *= 0xc4ceb9fe1a85ec53ULL;
+        hash ^= hash >> 33;
+        return hash;
+    }
+
+    // the low bits of hash pick the block, and its high 32 bits times a different odd constant for each word pick a bit in that word
+    static uint64_t bitInWord(uint32_t key, size_t word) {
+        static const uint32_t salts[WORDS_PER_BLOCK] = {0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+                                                        0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+        return uint64_t(1) << ((key * salts[word]) >> 26);
+    }
+
+    void add(uint64_t hash) {
+        uint64_t* block = words.data() + (hash & blockMask) * WORDS_PER_BLOCK;
+        uint32_t key = hash >> 32;
+        for (size_t w = 0; w < WORDS_PER_BLOCK; ++w)
+            block[w] |= bitInWord(key, w);
+    }
+
+    // false if a value with this hash was never added
+    bool mayContain(uint64_t hash) const {
+        const uint64_t* block = words.data() + (hash & blockMask) * WORDS_PER_BLOCK;
+        uint32_t key = hash >> 32;
+        uint64_t missing = 0;
+        for (size_t w = 0; w < WORDS_PER_BLOCK; ++w)
+            missing |= bitInWord(key, w) & ~block[w];
+        return missing == 0;
+    }
+};
+
+// how a bloom filter did over one execution, for PredicateProgram::describe()
+struct BloomStats {
+    size_t probes = 0;      // values checked
+    size_t rejected = 0;    // ruled out by the filter, so the set wasn't probed
+    size_t found = 0;       // in the set
+
+    // of the values that aren't in the set, the fraction the filter let through anyway
+    double falsePositiveRate() const {
+        size_t absent = probes - found;
+        return absent == 0 ? 0 : double(probes - rejected - found) / absent;
+    }
+};
+
+#endif
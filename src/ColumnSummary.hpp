@@ -0,0 +1,135 @@
+// ColumnSummary.hpp
+
+#ifndef COLUMNSUMMARY
+#define COLUMNSUMMARY
+
+#include <unordered_set>
+#include <algorithm>
+#include <type_traits>
+#include "Comparison.hpp"
+#include "BloomFilter.hpp"
+
+// what an any/all comparison needs to know about the rhs column, gathered once by open()
+// x < any t.c only needs max(t.c), x < all t.c only needs min(t.c), and == and != need the distinct values
+// past BLOOM_MIN_VALUES distinct values, the set no longer fits in cache, so finish() puts a BloomFilter in front of it
+template <typename T>
+struct ColumnSummary {
+    static const size_t BLOOM_MIN_VALUES = 16384;
+
+    bool hasNull = false;
+    bool hasNaN = false;          // floats only. NaN compares false with everything except !=
+    size_t count = 0;             // non-null values, NaN included
+    T min{};                      // min, max, and values leave out NaN
+    T max{};
+    std::unordered_set<T> values;
+    BloomFilter bloom;
+
+    static bool isNaN(const T& value) {
+        return !(value == value);
+    }
+
+    void addNull() {
+        hasNull = true;
+    }
+
+    void add(const T& value) {
+        ++count;
+        if (isNaN(value)) {
+            hasNaN = true;
+            return;
+        }
+        if (values.empty()) {
+            min = value;
+            max = value;
+        }
+        else {
+            min = std::min(min, value);
+            max = std::max(max, value);
+        }
+        values.insert(value);
+    }
+
+    // called once every value has been added
+    void finish() {
+        if (values.size() < BLOOM_MIN_VALUES)
+            return;
+        bloom.reserve(values.size());
+        for (const T& value : values)
+            bloom.add(hashOf(value));
+    }
+
+    // std::hash already treats 0.0 and -0.0 as the same float, like the set does
+    static uint64_t hashOf(const T& value) {
+        return BloomFilter::mix(std::hash<T>()(value));
+    }
+
+    // x is one of the values, checked against the bloom filter first if there is one. stats, if given, counts how that went
+    bool contains(const T& x, BloomStats* stats) const {
+        if (!bloom.enabled())
+            return values.count(x) != 0;
+        if (stats)
+            ++stats->probes;
+        if (!bloom.mayContain(hashOf(x))) {
+            if (stats)
+                ++stats->rejected;
+            return false;
+        }
+        bool found = values.count(x) != 0;
+        if (stats)
+            stats->found += found;
+        return found;
+    }
+
+    // x op any t.c, with op one of the std::equal_to<>() ... std::greater_equal<>() functors from withComparison()
+    // nulls in t.c are skipped, so an empty or all null t.c is false
+    template <typename Compare>
+    bool any(const T& x, BloomStats* stats = nullptr) const {
+        if (count == 0)
+            return false;
+
+        if constexpr (std::is_same_v<Compare, std::equal_to<>>)
+            return contains(x, stats);
+
+        // some value differs from x
+        else if constexpr (std::is_same_v<Compare, std::not_equal_to<>>)
+            return hasNaN || values.size() > 1 || (values.size() == 1 && *values.begin() != x);
+
+        else if constexpr (std::is_same_v<Compare, std::less<>> || std::is_same_v<Compare, std::less_equal<>>)
+            return !values.empty() && Compare()(x, max);
+
+        else
+            return !values.empty() && Compare()(x, min);
+    }
+
+    // x op all t.c. a null in t.c makes it false, this is mysql behavior, too. an empty t.c is true
+    template <typename Compare>
+    bool all(const T& x, BloomStats* stats = nullptr) const {
+        if (hasNull)
+            return false;
+        if (count == 0)
+            return true;
+
+        // every value is x
+        if constexpr (std::is_same_v<Compare, std::equal_to<>>)
+            return !hasNaN && values.size() == 1 && *values.begin() == x;
+
+        else if constexpr (std::is_same_v<Compare, std::not_equal_to<>>)
+            return !contains(x, stats);
+
+        else if constexpr (std::is_same_v<Compare, std::less<>> || std::is_same_v<Compare, std::less_equal<>>)
+            return !hasNaN && Compare()(x, min);
+
+        else
+            return !hasNaN && Compare()(x, max);
+    }
+
+    bool any(element_type op, const T& x, BloomStats* stats = nullptr) const {
+        return withComparison(op, [&](auto compare) { return any<decltype(compare)>(x, stats); });
+    }
+
+    bool all(element_type op, const T& x, BloomStats* stats = nullptr) const {
+        return withComparison(op, [&](auto compare) { return all<decltype(compare)>(x, stats); });
+    }
+};
+
+#endif
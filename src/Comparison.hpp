@@ -0,0 +1,40 @@
+// Comparison.hpp
+
+#ifndef COMPARISON
+#define COMPARISON
+
+#include <functional>
+#include "element_type.hpp"
+
+// call f with the std:: functor for a comparison operator, e.g. std::less<>() for op_less_than
+// f is instantiated once per operator, so a loop inside it compares with no branch on op
+template <typename F>
+inline decltype(auto) withComparison(element_type op, F f) {
+    switch (op) {
+        case op_equals: return f(std::equal_to<>());
+        case op_not_equals: return f(std::not_equal_to<>());
+        case op_less_than: return f(std::less<>());
+        case op_less_than_equals: return f(std::less_equal<>());
+        case op_greater_than: return f(std::greater<>());
+        default: return f(std::greater_equal<>());
+    }
+}
+
+// lhs op rhs, for the places that only compare once
+template <typename T>
+inline bool compareValues(element_type op, const T& lhs, const T& rhs) {
+    return withComparison(op, [&](auto compare) { return compare(lhs, rhs); });
+}
+
+// the operator with its sides swapped: lhs op rhs is rhs mirrored(op) lhs
+inline element_type mirrored(element_type op) {
+    switch (op) {
+        case op_less_than: return op_greater_than;
+        case op_less_than_equals: return op_greater_than_equals;
+        case op_greater_than: return op_less_than;
+        case op_greater_than_equals: return op_less_than_equals;
+        default: return op;
+    }
+}
+
+#endif
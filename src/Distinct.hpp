@@ -0,0 +1,191 @@
+// Distinct.hpp
+
+#ifndef DISTINCT
+#define DISTINCT
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <memory>
+#include <cstring>
+#include <cstdio>
+#include "TableInfo.hpp"
+#include "ResultSink.hpp"
+#include "Batch.hpp"
+#include "Join.hpp"
+
+// a select distinct whose distinct rows would take more than this many bytes to hash spills the rows it hasn't seen to partitions. see DistinctRows
+size_t DISTINCT_MEMORY_BUDGET = size_t(1) << 30;
+
+// how much a select distinct spilled to disk, for diagnostics
+struct DistinctStats {
+    size_t partitions = 0;      // spill files written, at every level
+    size_t spilledRows = 0;
+    size_t spilledBytes = 0;
+    int levels = 0;             // times the deepest partition was partitioned again, 1 for a single pass
+
+    // e.g. "spilled 1200000 rows, 20.6 MiB, to 64 partitions in 1 level", or empty if nothing spilled
+    std::string describe() const {
+        if (partitions == 0)
+            return "";
+        char description[128];
+        std::snprintf(description, sizeof(description), "spilled %zu rows, %.1f MiB, to %zu partitions in %d level%s",
+                      spilledRows, spilledBytes / double(1 << 20), partitions, levels, levels == 1 ? "" : "s");
+        return description;
+    }
+};
+
+// a row laid out by layout, in place, in a form two rows distinct counts as the same have the same bytes of:
+// a null cell's value is zeros, -0.0 is 0.0, and chars are zeros after their first '\0'
+void canonicalDistinctRow(const TableInfo& layout, char* row) {
+    for (const ColumnInfo& column : layout.columns) {
+        char* cell = row + column.offset;
+        if (cell[0])
+            std::memset(cell + 1, 0, column.bytesNeeded - 1);
+        else if (column.type == float_literal) {
+            float value;
+            std::memcpy(&value, cell + 1, sizeof(float));
+            value += 0.0f;
+            std::memcpy(cell + 1, &value, sizeof(float));
+        }
+        else if (column.type == chars_literal) {
+            size_t length = charsLengthOf(cell + 1, column.charsLength);
+            std::memset(cell + 1 + length, 0, column.charsLength - length);
+        }
+    }
+}
+
+// canonical rows, each kept once, in chunks that never move so the set can point into them
+struct RowSet {
+    static const size_t CHUNK_ROWS = 4096;
+
+    unsigned int rowSize;
+    std::vector<std::unique_ptr<char[]>> chunks;
+    size_t rows = 0;
+    std::unordered_set<std::string_view> set;
+
+    RowSet(unsigned int rowSize) : rowSize(rowSize) {}
+
+    // about how many bytes the set takes, counted the same as a JoinHashTable
+    size_t bytes() const {
+        return rows * (rowSize + HASH_BYTES_PER_ROW);
+    }
+
+    // where the next row goes, to be written there and then passed to insert()
+    char* next() {
+        if (rows == chunks.size() * CHUNK_ROWS)
+            chunks.push_back(std::make_unique<char[]>(CHUNK_ROWS * rowSize));
+        return chunks.back().get() + (rows % CHUNK_ROWS) * rowSize;
+    }
+
+    // keeps the row written at next(), false if an equal row was already kept
+    bool insert() {
+        char* row = next();
+        if (!set.insert(std::string_view(row, rowSize)).second)
+            return false;
+        ++rows;
+        return true;
+    }
+
+    bool contains(const char* row) const {
+        return set.count(std::string_view(row, rowSize)) != 0;
+    }
+};
+
+// hands sink the first of each set of equal rows, as they come, within DISTINCT_MEMORY_BUDGET.
+// once the set of rows seen so far would go past the budget, it stops growing: rows in it are still dropped as they come,
+// and every other row is spilled to a SpillFile by the hash of its canonical form, so equal rows land in the same one.
+// each spill file is made distinct after the last row, partitioned again if it's still too big, up to MAX_SPILL_LEVELS times
+struct DistinctRows {
+    const TableInfo& layout;
+    ResultSink& sink;
+    int level;
+    DistinctStats& stats;
+    unsigned int rowSize;
+    RowSet seen;
+    std::vector<std::unique_ptr<SpillFile>> spills;
+
+    DistinctRows(const TableInfo& layout, ResultSink& sink, int level, DistinctStats& stats)
+        : layout(layout), sink(sink), level(level), stats(stats), rowSize(layout.rowSize()), seen(rowSize) {}
+
+    void add(const char* row) {
+        char* canonical = seen.next();
+        std::memcpy(canonical, row, rowSize);
+        canonicalDistinctRow(layout, canonical);
+
+        // past the last level, a partition is mostly one row, which more partitioning can't split
+        if (spills.empty() && (seen.bytes() < DISTINCT_MEMORY_BUDGET || level == MAX_SPILL_LEVELS)) {
+            if (seen.insert())
+                sink.row(row);
+            return;
+        }
+
+        if (seen.contains(canonical))
+            return;
+        if (spills.empty()) {
+            spills.resize(MAX_SPILL_PARTITIONS);
+            stats.levels = std::max(stats.levels, level + 1);
+        }
+        std::unique_ptr<SpillFile>& spill = spills[partitionOf(std::string_view(canonical, rowSize), level, MAX_SPILL_PARTITIONS)];
+        if (!spill) {
+            spill = std::make_unique<SpillFile>(rowSize);
+            ++stats.partitions;
+        }
+        spill->write(row);
+        ++stats.spilledRows;
+        stats.spilledBytes += rowSize;
+    }
+
+    // the spilled rows, after the last add()
+    void finish() {
+        seen = RowSet(rowSize);
+        std::vector<char> block;
+        for (auto& spill : spills) {
+            if (!spill)
+                continue;
+            DistinctRows partition(layout, sink, level + 1, stats);
+            block.resize(BATCH_SIZE * rowSize);
+            spill->reset();
+            while (size_t count = spill->readBlock(block.data(), BATCH_SIZE))
+                for (size_t i = 0; i < count; ++i)
+                    partition.add(block.data() + i * rowSize);
+            spill.reset();
+            partition.finish();
+        }
+        spills.clear();
+    }
+};
+
+// hands sink one of each set of equal rows. see DistinctRows
+struct DistinctSink : ResultSink {
+    ResultSink& sink;
+    TableInfo layout;
+    std::unique_ptr<DistinctRows> rows;
+    DistinctStats stats;
+
+    DistinctSink(ResultSink& sink) : sink(sink) {}
+
+    void begin(const std::string& statement, const std::string& tables, const TableInfo& rowLayout) override {
+        layout = rowLayout;
+        stats = DistinctStats();
+        rows = std::make_unique<DistinctRows>(layout, sink, 0, stats);
+        sink.begin(statement, tables, layout);
+    }
+
+    void row(const char* rowBytes) override {
+        rows->add(rowBytes);
+    }
+
+    void end() override {
+        rows->finish();
+        rows.reset();
+        sink.end();
+    }
+
+    void setFormat(const std::string& format) override {
+        sink.setFormat(format);
+    }
+};
+
+#endif
@@ -0,0 +1,1082 @@
+// Join.hpp
+
+#ifndef JOIN
+#define JOIN
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <filesystem>
+#include <cstring>
+#include <cstdint>
+#include <type_traits>
+#include <algorithm>
+#include <memory>
+#include <fstream>
+#include <random>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <map>
+#include <exception>
+#include <cstdio>
+#include "TableInfo.hpp"
+#include "Table.hpp"
+#include "ResultSink.hpp"
+#include "Batch.hpp"
+#include "PredicateProgram.hpp"
+#include "BloomFilter.hpp"
+#include "QueryError.hpp"
+
+// a == join whose smaller table would take more than this many bytes to hash is partitioned to spill files first. see joinPartitioned()
+size_t JOIN_MEMORY_BUDGET = size_t(1) << 30;
+
+// spill files go here, the system's temporary directory when empty
+std::string SPILL_DIRECTORY = "";
+
+// a join whose build side would go past JOIN_MEMORY_BUDGET, and has at least this many bytes of columns other than its key,
+// reads that side as just keys and row positions, and reads the rest of each matched row back from the table after. see LateColumns
+size_t LATE_MATERIALIZATION_MIN_BYTES = 64;
+
+// how much a join spilled to disk, and read back late, for diagnostics
+struct JoinStats {
+    size_t partitions = 0;      // partitions spilled, each to one file of each table's rows
+    size_t spilledRows = 0;
+    size_t spilledBytes = 0;
+    int levels = 0;             // times the deepest partition was partitioned again, 1 for a single pass
+    size_t lateRows = 0;        // build rows read back from their table by position, once for each batch of joined rows that has them
+
+    // e.g. "spilled 1200000 rows, 20.6 MiB, to 15 partitions in 1 level", "read 250000 rows back late", both, or empty for neither
+    std::string describe() const {
+        char description[192] = "";
+        int length = 0;
+        if (partitions != 0)
+            length = std::snprintf(description, sizeof(description), "spilled %zu rows, %.1f MiB, to %zu partitions in %d level%s",
+                                   spilledRows, spilledBytes / double(1 << 20), partitions, levels, levels == 1 ? "" : "s");
+        if (lateRows != 0)
+            std::snprintf(description + length, sizeof(description) - length, "%sread %zu rows back late", length ? ", " : "", lateRows);
+        return description;
+    }
+};
+
+// rows written to a temporary file and read back, in the same layout and with the same readBlock() as a Table. removed when destroyed
+struct SpillFile {
+    std::filesystem::path path;
+    std::fstream file;
+    unsigned int rowSize;
+    size_t rows = 0;
+
+    SpillFile(unsigned int rowSize) : rowSize(rowSize) {
+        static const unsigned int process = std::random_device()();
+        static std::atomic<unsigned long> files{0};
+        std::filesystem::path directory = SPILL_DIRECTORY.empty() ? std::filesystem::temp_directory_path() : std::filesystem::path(SPILL_DIRECTORY);
+        path = directory / ("femtoql_" + std::to_string(process) + "_" + std::to_string(files++) + ".spill");
+        file.open(path, std::ios_base::in | std::ios_base::out | std::ios_base::trunc | std::ios_base::binary);
+        if (!file)
+            throw QueryError() << "Couldn't create the spill file \"" << path.string() << "\".\n";
+    }
+
+    ~SpillFile() {
+        file.close();
+        std::error_code ignored;
+        std::filesystem::remove(path, ignored);
+    }
+
+    void write(const char* row) {
+        file.write(row, rowSize);
+        ++rows;
+    }
+
+    // back to the first row, for reading
+    void reset() {
+        file.flush();
+        file.clear();
+        file.seekg(0, std::ios_base::beg);
+    }
+
+    size_t readBlock(char* buffer, size_t maxRows) {
+        file.read(buffer, maxRows * rowSize);
+        size_t rowsRead = file.gcount() / rowSize;
+        file.clear();
+        return rowsRead;
+    }
+};
+
+// the live rows of a table or spill file, read into memory with their delete bytes, rowSize bytes apart
+struct RowStore {
+    unsigned int rowSize = 0;
+    std::vector<char> bytes;
+
+    size_t size() const {
+        return rowSize == 0 ? 0 : bytes.size() / rowSize;
+    }
+
+    const char* operator[](size_t i) const {
+        return bytes.data() + i * rowSize;
+    }
+
+    void append(const char* row) {
+        bytes.insert(bytes.end(), row, row + rowSize);
+    }
+
+    template <typename Source>
+    void read(Source& source) {
+        rowSize = source.rowSize;
+        bytes.clear();
+        std::vector<char> block(BATCH_SIZE * rowSize);
+        source.reset();
+        while (size_t count = source.readBlock(block.data(), BATCH_SIZE)) {
+            for (size_t i = 0; i < count; ++i) {
+                const char* row = block.data() + i * rowSize;
+                if (!row[0])
+                    append(row);
+            }
+        }
+        source.reset();
+    }
+};
+
+// about how many rows a table has, deleted ones included, from the size of its file
+inline size_t approximateRows(const Table& table) {
+    std::uintmax_t fileSize = std::filesystem::file_size(TABLE_DIRECTORY + table.t.name + FILE_EXTENSION);
+    return fileSize <= table.dataStartPosition ? 0 : (fileSize - table.dataStartPosition) / table.rowSize;
+}
+
+// copies some of the columns of a row into another row, each column a run of its null byte and value, with adjacent runs merged
+struct RowProjection {
+    struct Run {
+        unsigned int from;
+        unsigned int to;
+        unsigned int length;
+    };
+    std::vector<Run> runs;
+
+    void add(const ColumnInfo& from, const ColumnInfo& to) {
+        if (!runs.empty() && runs.back().from + runs.back().length == unsigned(from.offset) && runs.back().to + runs.back().length == unsigned(to.offset))
+            runs.back().length += to.bytesNeeded;
+        else
+            runs.push_back(Run{unsigned(from.offset), unsigned(to.offset), unsigned(to.bytesNeeded)});
+    }
+
+    void copy(const char* source, char* row) const {
+        for (const Run& run : runs)
+            std::memcpy(row + run.to, source + run.from, run.length);
+    }
+};
+
+// a table as a join reads it, with the same reset() and readBlock(). rows its filter rules out are read as deleted,
+// so they're never indexed, probed, or spilled. a join's filters are the conjuncts of its where clause on one table alone.
+// given a layout of some of the table's columns, rows are read narrowed to those columns, so the rest aren't carried
+// through indexing, spilling, and joining either
+struct JoinInput {
+    Table& table;
+    PredicateProgram* filter;       // none when nullptr
+    unsigned int rowSize;
+    std::vector<uint16_t> selection;
+    bool narrowed = false;
+    RowProjection projection;
+    std::vector<char> wideBlock;
+    bool positions = false;         // read as a key and the row's position in the table, see readKeyAndPosition()
+    size_t rowsRead = 0;
+
+    JoinInput(Table& table, PredicateProgram* filter = nullptr, const TableInfo* layout = nullptr) : table(table), filter(filter), rowSize(table.rowSize) {
+        if (!layout || layout->columns.size() == table.t.columns.size())
+            return;
+        narrowed = true;
+        rowSize = layout->rowSize();
+        for (const ColumnInfo& column : layout->columns)
+            projection.add(*table.t[column.name], column);
+    }
+
+    void reset() {
+        table.reset();
+        rowsRead = 0;
+    }
+
+    // read rows as just the key column and, in the last 4 bytes, the row's position in the table. returns the key column as read
+    ColumnInfo readKeyAndPosition(const ColumnInfo& key) {
+        ColumnInfo keyColumn(key);
+        keyColumn.offset = 1;
+        projection = RowProjection();
+        projection.add(*table.t[key.name], keyColumn);
+        narrowed = true;
+        positions = true;
+        rowSize = 1 + key.bytesNeeded + sizeof(uint32_t);
+        return keyColumn;
+    }
+
+    // a row of the table as this reads it
+    void project(const char* source, char* row) const {
+        row[0] = source[0];
+        if (narrowed)
+            projection.copy(source, row);
+        else
+            std::copy(source + 1, source + rowSize, row + 1);
+    }
+
+    size_t readBlock(char* buffer, size_t maxRows) {
+        char* rows = buffer;
+        if (narrowed) {
+            wideBlock.resize(maxRows * table.rowSize);
+            rows = wideBlock.data();
+        }
+        size_t count = table.readBlock(rows, maxRows);
+        if (count == 0)
+            return count;
+        if (filter) {
+            filter->select(rows, table.rowSize, count, selection);
+            size_t next = 0;
+            for (size_t i = 0; i < count; ++i) {
+                if (next < selection.size() && selection[next] == i)
+                    ++next;
+                else
+                    rows[i * table.rowSize] = 1;
+            }
+        }
+        // deleted rows are only read as far as their delete byte
+        if (narrowed) {
+            for (size_t i = 0; i < count; ++i) {
+                if ((buffer[i * rowSize] = rows[i * table.rowSize]))
+                    continue;
+                projection.copy(rows + i * table.rowSize, buffer + i * rowSize);
+                if (positions) {
+                    uint32_t position = rowsRead + i;
+                    std::memcpy(buffer + (i + 1) * rowSize - sizeof(uint32_t), &position, sizeof(uint32_t));
+                }
+            }
+        }
+        rowsRead += count;
+        return count;
+    }
+};
+
+// before its filter
+inline size_t approximateRows(const JoinInput& input) {
+    return approximateRows(input.table);
+}
+
+inline size_t approximateRows(const SpillFile& spillFile) {
+    return spillFile.rows;
+}
+
+// the value of a non-null cell, given a pointer to its null byte, as a hash key
+// chars keys point into the row they were read from and leave out the '\0' padding, so they match the way compareCell() does
+template <typename Key>
+Key joinKey(const char* cell, int charsLength) {
+    if constexpr (std::is_same_v<Key, std::string_view>)
+        return std::string_view(cell + 1, charsLengthOf(cell + 1, charsLength));
+    else if constexpr (std::is_same_v<Key, bool>)
+        return cell[1] != 0;
+    else {
+        Key value;
+        std::memcpy(&value, cell + 1, sizeof(Key));
+        return value;
+    }
+}
+
+// a null key, or a NaN one, equals nothing, so it is never put in or looked up in the hash table
+template <typename Key>
+bool joinable(const char* cell, const Key& key) {
+    if (*cell)
+        return false;
+    if constexpr (std::is_same_v<Key, float>)
+        return key == key;
+    return true;
+}
+
+// threads a join may build and probe on, every core unless changed
+unsigned int JOIN_THREADS = std::max(1u, std::thread::hardware_concurrency());
+
+// joins with fewer rows than this on a side don't use more than one thread for that side
+const size_t PARALLEL_JOIN_MIN_ROWS = 1 << 16;
+
+// call work(i) on threads threads, i from 0 to threads - 1, and wait for them. the first exception thrown is rethrown here
+// stop is set once work throws, for the others to check
+template <typename Work>
+void runOnThreads(unsigned int threads, std::atomic<bool>& stop, Work&& work) {
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    std::vector<std::thread> running;
+    for (unsigned int i = 0; i < threads; ++i) {
+        running.emplace_back([&, i] {
+            try {
+                work(i);
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error)
+                    error = std::current_exception();
+                stop = true;
+            }
+        });
+    }
+    for (auto& thread : running)
+        thread.join();
+    if (error)
+        std::rethrow_exception(error);
+}
+
+// the rows of a RowStore by the value of one column: first holds the first row with each value, and next chains the rest in row order
+// with more than one thread, values are split over a map per thread by their hash, and each thread builds its own map
+template <typename Key>
+struct JoinHashTable {
+    static constexpr uint32_t NONE = UINT32_MAX;
+    static const uint8_t UNJOINABLE = UINT8_MAX;
+
+    std::vector<std::unordered_map<Key, uint32_t>> first;
+    std::vector<uint32_t> next;
+
+    // the map a key is in. the high bits of its hash, since spilling partitions on the low ones
+    size_t mapOf(const Key& key) const {
+        return (BloomFilter::mix(std::hash<Key>()(key)) >> 40) & (first.size() - 1);
+    }
+
+    // offset is the column's null byte
+    void build(const RowStore& rows, unsigned int offset, int charsLength) {
+        size_t maps = 1;
+        while (maps * 2 <= JOIN_THREADS && maps < UNJOINABLE && rows.size() >= PARALLEL_JOIN_MIN_ROWS)
+            maps *= 2;
+        first.assign(maps, {});
+        next.assign(rows.size(), NONE);
+
+        // back to front, so each row goes in front of the later rows with its value
+        auto insert = [&](size_t map, size_t i) {
+            const char* cell = rows[i] + offset;
+            Key key = joinKey<Key>(cell, charsLength);
+            auto inserted = first[map].try_emplace(key, uint32_t(i));
+            if (!inserted.second) {
+                next[i] = inserted.first->second;
+                inserted.first->second = uint32_t(i);
+            }
+        };
+
+        if (maps == 1) {
+            first[0].reserve(rows.size());
+            for (size_t i = rows.size(); i-- > 0;) {
+                const char* cell = rows[i] + offset;
+                if (joinable(cell, joinKey<Key>(cell, charsLength)))
+                    insert(0, i);
+            }
+            return;
+        }
+
+        // each thread finds the map of a slice of the rows, then fills one map from all of them
+        std::vector<uint8_t> mapOfRow(rows.size());
+        std::atomic<bool> stop{false};
+        size_t slice = (rows.size() + maps - 1) / maps;
+        runOnThreads(maps, stop, [&](unsigned int thread) {
+            for (size_t i = thread * slice; i < std::min(rows.size(), (thread + 1) * slice); ++i) {
+                const char* cell = rows[i] + offset;
+                Key key = joinKey<Key>(cell, charsLength);
+                mapOfRow[i] = joinable(cell, key) ? mapOf(key) : UNJOINABLE;
+            }
+        });
+        runOnThreads(maps, stop, [&](unsigned int map) {
+            first[map].reserve(rows.size() / maps);
+            for (size_t i = rows.size(); i-- > 0;)
+                if (mapOfRow[i] == map)
+                    insert(map, i);
+        });
+    }
+
+    // call emit(i) for each row i whose value equals this cell's, in row order. op is always ==
+    template <typename Emit>
+    void probe(const char* cell, int charsLength, element_type op, Emit&& emit) const {
+        Key key = joinKey<Key>(cell, charsLength);
+        if (!joinable(cell, key))
+            return;
+        const auto& map = first.size() == 1 ? first[0] : first[mapOf(key)];
+        auto found = map.find(key);
+        if (found == map.end())
+            return;
+        for (uint32_t i = found->second; i != NONE; i = next[i])
+            emit(i);
+    }
+};
+
+// the rows of a RowStore sorted by the value of one column, so the rows a <, <=, >, or >= comparison matches are one range of them
+template <typename Key>
+struct SortedJoinKeys {
+    std::vector<std::pair<Key, uint32_t>> keys;     // value and row, by value then row
+    std::vector<std::pair<Key, uint32_t>> rowOrder; // the same, by row
+
+    void build(const RowStore& rows, unsigned int offset, int charsLength) {
+        keys.clear();
+        keys.reserve(rows.size());
+        for (size_t i = 0; i < rows.size(); ++i) {
+            const char* cell = rows[i] + offset;
+            Key key = joinKey<Key>(cell, charsLength);
+            if (joinable(cell, key))
+                keys.push_back({key, uint32_t(i)});
+        }
+        rowOrder = keys;
+        std::sort(keys.begin(), keys.end());
+    }
+
+    // call emit(i) for each row i where this cell's value op row i's value is true, in row order, the same as a nested loop.
+    // a range of more than a quarter of the rows is found by checking every row in row order, and a smaller one is sorted by row
+    template <typename Emit>
+    void probe(const char* cell, int charsLength, element_type op, Emit&& emit) const {
+        Key key = joinKey<Key>(cell, charsLength);
+        if (!joinable(cell, key))
+            return;
+        auto lower = [](const std::pair<Key, uint32_t>& entry, const Key& key) { return entry.first < key; };
+        auto upper = [](const Key& key, const std::pair<Key, uint32_t>& entry) { return key < entry.first; };
+        auto begin = keys.begin();
+        auto end = keys.end();
+        switch (op) {
+            case op_less_than: begin = std::upper_bound(keys.begin(), keys.end(), key, upper); break;
+            case op_less_than_equals: begin = std::lower_bound(keys.begin(), keys.end(), key, lower); break;
+            case op_greater_than: end = std::lower_bound(keys.begin(), keys.end(), key, lower); break;
+            case op_greater_than_equals: end = std::upper_bound(keys.begin(), keys.end(), key, upper); break;
+            default:
+                throw QueryError() << "Error in SortedJoinKeys::probe(). Somehow, a join's operator is not one of <, <=, >, or >=.\n";
+        }
+        if (size_t(end - begin) > keys.size() / 4) {
+            for (const auto& entry : rowOrder)
+                if (compareValues(op, key, entry.first))
+                    emit(entry.second);
+            return;
+        }
+        std::vector<uint32_t> matches;
+        matches.reserve(end - begin);
+        for (auto i = begin; i != end; ++i)
+            matches.push_back(i->second);
+        std::sort(matches.begin(), matches.end());
+        for (uint32_t match : matches)
+            emit(match);
+    }
+};
+
+// the non-null values of one column of a RowStore in row order, for a != comparison, which matches nearly every row, so there's nothing to look up
+template <typename Key>
+struct ScanJoinKeys {
+    std::vector<std::pair<Key, uint32_t>> keys;     // value and row, by row
+
+    void build(const RowStore& rows, unsigned int offset, int charsLength) {
+        keys.clear();
+        keys.reserve(rows.size());
+        for (size_t i = 0; i < rows.size(); ++i) {
+            const char* cell = rows[i] + offset;
+            if (!*cell)
+                keys.push_back({joinKey<Key>(cell, charsLength), uint32_t(i)});
+        }
+    }
+
+    // call emit(i) for each row i where this cell's value op row i's value is true, in row order. NaN is != everything
+    template <typename Emit>
+    void probe(const char* cell, int charsLength, element_type op, Emit&& emit) const {
+        if (*cell)
+            return;
+        Key key = joinKey<Key>(cell, charsLength);
+        for (const auto& entry : keys)
+            if (compareValues(op, key, entry.first))
+                emit(entry.second);
+    }
+};
+
+// a join's two tables in the order it reads them: the build side is read into an index, and each row of the probe side is looked up in it
+// joined rows are still table1's row followed by table2's, whichever side table1 is
+struct JoinSides {
+    bool buildTable1;               // table1 is the build side
+    const ColumnInfo& buildColumn;
+    const ColumnInfo& probeColumn;
+    element_type probeOp;           // a probe row's value op a build row's value, the join's operator mirrored when table1 is the build side
+    unsigned int rowSize1;
+    unsigned int rowSize2;
+    std::vector<char>& row;
+    ResultSink& sink;
+
+    // write the joined row, delete byte included, to joined
+    void join(const char* buildRow, const char* probeRow, char* joined) const {
+        const char* row1 = buildTable1 ? buildRow : probeRow;
+        const char* row2 = buildTable1 ? probeRow : buildRow;
+        joined[0] = '\0';
+        std::copy(row1 + 1, row1 + rowSize1, joined + 1);
+        std::copy(row2 + 1, row2 + rowSize2, joined + rowSize1);
+    }
+
+    void emit(const char* buildRow, const char* probeRow) {
+        join(buildRow, probeRow, row.data());
+        sink.row(row.data());
+    }
+};
+
+// joined rows made by several threads a block of probe rows at a time, handed to the sink in the order the blocks were read
+// so a parallel join gives rows in the same order as a join on one thread. only one thread calls the sink at a time
+struct OrderedJoinOutput {
+    std::mutex mutex;
+    std::map<size_t, std::vector<char>> waiting;    // joined rows by block, for blocks read after one that isn't done yet
+    size_t next = 0;
+    unsigned int rowSize;
+    ResultSink& sink;
+
+    OrderedJoinOutput(unsigned int rowSize, ResultSink& sink) : rowSize(rowSize), sink(sink) {}
+
+    void add(size_t block, std::vector<char>&& rows) {
+        std::lock_guard<std::mutex> lock(mutex);
+        waiting.emplace(block, std::move(rows));
+        while (!waiting.empty() && waiting.begin()->first == next) {
+            const std::vector<char>& ready = waiting.begin()->second;
+            for (size_t offset = 0; offset < ready.size(); offset += rowSize)
+                sink.row(ready.data() + offset);
+            waiting.erase(waiting.begin());
+            ++next;
+        }
+    }
+};
+
+// read through probe once, block by block, calling joinBlock(block, count, joined) on each block of count rows to append the rows
+// its live rows join to joined, and hand the joined rows to sink in the order probe was read. probe is a Table, JoinInput, or SpillFile
+// past PARALLEL_JOIN_MIN_ROWS probe rows, JOIN_THREADS threads take turns reading a block and join the blocks they read at the same time,
+// each into its own buffer, which OrderedJoinOutput passes on in the order the blocks were read.
+// makeJoinBlock() is called once on each thread, so each joinBlock can keep state of its own
+template <typename ProbeSource, typename MakeJoinBlock>
+void joinBlocks(ProbeSource& probe, unsigned int joinedRowSize, ResultSink& sink, MakeJoinBlock&& makeJoinBlock) {
+    probe.reset();
+    if (JOIN_THREADS > 1 && approximateRows(probe) >= PARALLEL_JOIN_MIN_ROWS) {
+        OrderedJoinOutput output(joinedRowSize, sink);
+        std::mutex readMutex;
+        size_t blocksRead = 0;
+        std::atomic<bool> stop{false};
+        runOnThreads(JOIN_THREADS, stop, [&](unsigned int thread) {
+            auto joinBlock = makeJoinBlock();
+            std::vector<char> block(BATCH_SIZE * probe.rowSize);
+            while (!stop) {
+                size_t count, blockNumber;
+                {
+                    std::lock_guard<std::mutex> lock(readMutex);
+                    count = probe.readBlock(block.data(), BATCH_SIZE);
+                    blockNumber = blocksRead++;
+                }
+                if (count == 0)
+                    break;
+                std::vector<char> joined;
+                joinBlock(block.data(), count, joined);
+                output.add(blockNumber, std::move(joined));
+            }
+        });
+        probe.reset();
+        return;
+    }
+
+    auto joinBlock = makeJoinBlock();
+    std::vector<char> block(BATCH_SIZE * probe.rowSize);
+    std::vector<char> joined;
+    while (size_t count = probe.readBlock(block.data(), BATCH_SIZE)) {
+        joined.clear();
+        joinBlock(block.data(), count, joined);
+        for (size_t offset = 0; offset < joined.size(); offset += joinedRowSize)
+            sink.row(joined.data() + offset);
+    }
+    probe.reset();
+}
+
+// read build into an Index, a JoinHashTable or SortedJoinKeys, then read through probe once with joinBlocks(),
+// joining each of its live rows with the build rows it matches. build and probe are Tables or SpillFiles
+// a JoinHashTable or SortedJoinKeys built on table2 gives rows in the same order as a nested loop over table1 then table2 does.
+// built on table1, the rows come in table2's order, and then table1's for each table2 row
+template <typename Index, typename BuildSource, typename ProbeSource>
+void joinInMemory(BuildSource& build, ProbeSource& probe, JoinSides& sides) {
+    RowStore rows;
+    rows.read(build);
+    if (rows.size() == 0)
+        return;
+    Index index;
+    index.build(rows, sides.buildColumn.offset, sides.buildColumn.charsLength);
+
+    unsigned int joinedRowSize = sides.rowSize1 + sides.rowSize2 - 1;
+    joinBlocks(probe, joinedRowSize, sides.sink, [&] {
+        return [&](const char* block, size_t count, std::vector<char>& joined) {
+            for (size_t i = 0; i < count; ++i) {
+                const char* probeRow = block + i * probe.rowSize;
+                if (probeRow[0])
+                    continue;
+                index.probe(probeRow + sides.probeColumn.offset, sides.probeColumn.charsLength, sides.probeOp, [&](uint32_t match) {
+                    joined.resize(joined.size() + joinedRowSize);
+                    sides.join(rows[match], probeRow, joined.data() + joined.size() - joinedRowSize);
+                });
+            }
+        };
+    });
+}
+
+// about how many bytes a JoinHashTable takes per row, on top of the row itself
+const size_t HASH_BYTES_PER_ROW = 48;
+// spill partitions per level, past which a partition that's still too big is partitioned again, up to MAX_SPILL_LEVELS times
+const size_t MAX_SPILL_PARTITIONS = 64;
+const int MAX_SPILL_LEVELS = 4;
+
+// which of partitions partitions a key goes in at a level of partitioning, each level taking different bits of its hash
+template <typename Key>
+size_t partitionOf(const Key& key, int level, size_t partitions) {
+    return (BloomFilter::mix(std::hash<Key>()(key)) >> (level * 8)) & (partitions - 1);
+}
+
+// a hybrid hash join of ==, within JOIN_MEMORY_BUDGET
+// when hashing build's buildRows rows would take more than the budget, both sides are partitioned by the hash of their keys so equal keys
+// land in the same partition. partition 0 of build stays in memory and the probe rows in it are joined as they are read,
+// and every other partition goes to a pair of SpillFiles and is joined afterwards, partitioned again if it's still too big.
+// rows with null or NaN keys match nothing, so they are dropped instead of spilled
+template <typename Key, typename BuildSource, typename ProbeSource>
+void joinPartitioned(BuildSource& build, size_t buildRows, ProbeSource& probe, JoinSides& sides, int level, JoinStats& stats) {
+    size_t buildBytes = buildRows * (build.rowSize + HASH_BYTES_PER_ROW);
+    // past the last level, a partition is mostly one key, which more partitioning can't split
+    if (buildBytes <= JOIN_MEMORY_BUDGET || level == MAX_SPILL_LEVELS) {
+        joinInMemory<JoinHashTable<Key>>(build, probe, sides);
+        return;
+    }
+
+    // enough partitions that each is about half the budget
+    size_t partitions = 2;
+    while (partitions < MAX_SPILL_PARTITIONS && partitions * JOIN_MEMORY_BUDGET < 2 * buildBytes)
+        partitions *= 2;
+    stats.levels = std::max(stats.levels, level + 1);
+
+    std::vector<std::unique_ptr<SpillFile>> buildSpills(partitions);
+    std::vector<std::unique_ptr<SpillFile>> probeSpills(partitions);
+    auto spill = [&stats](std::unique_ptr<SpillFile>& spillFile, const char* row, unsigned int rowSize, bool buildSide) {
+        if (!spillFile) {
+            spillFile = std::make_unique<SpillFile>(rowSize);
+            stats.partitions += buildSide;
+        }
+        spillFile->write(row);
+        ++stats.spilledRows;
+        stats.spilledBytes += rowSize;
+    };
+
+    {
+        RowStore kept;
+        kept.rowSize = build.rowSize;
+        std::vector<char> block(BATCH_SIZE * build.rowSize);
+        build.reset();
+        while (size_t count = build.readBlock(block.data(), BATCH_SIZE)) {
+            for (size_t i = 0; i < count; ++i) {
+                const char* row = block.data() + i * build.rowSize;
+                const char* cell = row + sides.buildColumn.offset;
+                Key key = joinKey<Key>(cell, sides.buildColumn.charsLength);
+                if (row[0] || !joinable(cell, key))
+                    continue;
+                size_t partition = partitionOf(key, level, partitions);
+                if (partition == 0)
+                    kept.append(row);
+                else
+                    spill(buildSpills[partition], row, build.rowSize, true);
+            }
+        }
+        build.reset();
+
+        JoinHashTable<Key> index;
+        index.build(kept, sides.buildColumn.offset, sides.buildColumn.charsLength);
+
+        block.resize(BATCH_SIZE * probe.rowSize);
+        probe.reset();
+        while (size_t count = probe.readBlock(block.data(), BATCH_SIZE)) {
+            for (size_t i = 0; i < count; ++i) {
+                const char* row = block.data() + i * probe.rowSize;
+                const char* cell = row + sides.probeColumn.offset;
+                Key key = joinKey<Key>(cell, sides.probeColumn.charsLength);
+                if (row[0] || !joinable(cell, key))
+                    continue;
+                size_t partition = partitionOf(key, level, partitions);
+                if (partition == 0)
+                    index.probe(cell, sides.probeColumn.charsLength, sides.probeOp, [&](uint32_t match) { sides.emit(kept[match], row); });
+                // a probe row whose build partition is empty matches nothing
+                else if (buildSpills[partition])
+                    spill(probeSpills[partition], row, probe.rowSize, false);
+            }
+        }
+        probe.reset();
+    }
+
+    for (size_t partition = 1; partition < partitions; ++partition) {
+        if (buildSpills[partition] && probeSpills[partition])
+            joinPartitioned<Key>(*buildSpills[partition], buildSpills[partition]->rows, *probeSpills[partition], sides, level + 1, stats);
+        buildSpills[partition].reset();
+        probeSpills[partition].reset();
+    }
+}
+
+// joined rows whose build side was read as keys and positions, with the rest of each build row read back from its table.
+// a batch of joined rows at a time, the positions are sorted and the rows read in that order, rows near each other in one read,
+// so the table is read front to back at most once a batch. the joined rows go on to sink in the order they came, with the build
+// side's columns in place of its key and position
+struct LateColumns : ResultSink {
+    // rows no further apart than this are read together, and the rows between them thrown away
+    static const size_t READ_AHEAD_BYTES = 1 << 16;
+
+    std::ifstream file;
+    unsigned int dataStartPosition;
+    unsigned int tableRowSize;
+    RowProjection columns;          // a table row to the build side's columns in a joined row
+    unsigned int buildOffset;       // where the build side starts in a joined row, less its delete byte
+    unsigned int positionOffset;    // where the position is in a row that comes in
+    RowProjection probeColumns;     // a row that comes in to the probe side's columns in a joined row
+    unsigned int lateRowSize;
+    unsigned int joinedRowSize;
+    ResultSink& sink;
+    JoinStats& stats;
+    std::vector<char> late;         // a batch of rows that came in
+    std::vector<char> joined;
+    std::vector<std::pair<uint32_t, uint32_t>> order;   // position, and row in the batch
+    std::vector<char> read;
+
+    // build is the build side before readKeyAndPosition(key), and probeRowSize the probe side's row size
+    LateColumns(const JoinInput& build, const ColumnInfo& key, bool buildTable1, unsigned int probeRowSize, ResultSink& sink, JoinStats& stats)
+        : file(TABLE_DIRECTORY + build.table.t.name + FILE_EXTENSION, std::ios_base::binary), dataStartPosition(build.table.dataStartPosition),
+          tableRowSize(build.table.rowSize), sink(sink), stats(stats) {
+        if (build.narrowed)
+            columns = build.projection;
+        else
+            columns.runs.push_back(RowProjection::Run{1, 1, build.rowSize - 1});
+        buildOffset = buildTable1 ? 0 : probeRowSize - 1;
+        joinedRowSize = build.rowSize + probeRowSize - 1;
+
+        // rows come in with the build side as readKeyAndPosition() reads it, and the probe side after it moves by however much narrower that is
+        unsigned int lateBuildRowSize = 1 + key.bytesNeeded + sizeof(uint32_t);
+        lateRowSize = lateBuildRowSize + probeRowSize - 1;
+        positionOffset = (buildTable1 ? 0 : probeRowSize - 1) + lateBuildRowSize - sizeof(uint32_t);
+        probeColumns.runs.push_back(RowProjection::Run{buildTable1 ? lateBuildRowSize : 1, buildTable1 ? build.rowSize : 1, probeRowSize - 1});
+        late.reserve(BATCH_SIZE * lateRowSize);
+    }
+
+    void begin(const std::string& statement, const std::string& tables, const TableInfo& layout) override {
+        sink.begin(statement, tables, layout);
+    }
+
+    void row(const char* rowBytes) override {
+        late.insert(late.end(), rowBytes, rowBytes + lateRowSize);
+        if (late.size() == BATCH_SIZE * lateRowSize)
+            flush();
+    }
+
+    void end() override {
+        flush();
+        sink.end();
+    }
+
+    void setFormat(const std::string& format) override {
+        sink.setFormat(format);
+    }
+
+    void flush() {
+        size_t rows = late.size() / lateRowSize;
+        if (rows == 0)
+            return;
+        order.clear();
+        for (size_t i = 0; i < rows; ++i) {
+            uint32_t position;
+            std::memcpy(&position, late.data() + i * lateRowSize + positionOffset, sizeof(uint32_t));
+            order.push_back({position, uint32_t(i)});
+        }
+        std::sort(order.begin(), order.end());
+
+        joined.assign(rows * joinedRowSize, '\0');
+        size_t readAheadRows = std::max<size_t>(1, READ_AHEAD_BYTES / tableRowSize);
+        for (size_t first = 0; first < order.size();) {
+            // the rows from this position to the last one close enough after it
+            size_t last = first;
+            while (last + 1 < order.size() && order[last + 1].first - order[first].first < readAheadRows)
+                ++last;
+            size_t span = order[last].first - order[first].first + 1;
+            read.resize(span * tableRowSize);
+            file.clear();
+            file.seekg(dataStartPosition + std::streamoff(order[first].first) * tableRowSize, std::ios_base::beg);
+            file.read(read.data(), span * tableRowSize);
+            for (size_t i = first; i <= last; ++i) {
+                char* row = joined.data() + order[i].second * joinedRowSize;
+                columns.copy(read.data() + size_t(order[i].first - order[first].first) * tableRowSize, row + buildOffset);
+                stats.lateRows += i == first || order[i].first != order[i - 1].first;
+            }
+            first = last + 1;
+        }
+
+        for (size_t i = 0; i < rows; ++i) {
+            char* row = joined.data() + i * joinedRowSize;
+            probeColumns.copy(late.data() + i * lateRowSize, row);
+            sink.row(row);
+        }
+        late.clear();
+    }
+};
+
+// whether to read build as keys and positions: its rows would go past JOIN_MEMORY_BUDGET, and are mostly columns other than the key
+inline bool lateMaterializable(const JoinInput& build, size_t buildRows, const ColumnInfo& buildColumn) {
+    return buildRows * (build.rowSize + HASH_BYTES_PER_ROW) > JOIN_MEMORY_BUDGET && buildRows < UINT32_MAX
+           && build.rowSize - 1 - buildColumn.bytesNeeded >= LATE_MATERIALIZATION_MIN_BYTES;
+}
+
+// a join of table1.column1 op table2.column2 on Key values, reading the table with fewer rows into memory
+// == joins hash, spilling past JOIN_MEMORY_BUDGET, and <, <=, >, and >= joins sort
+template <typename Key>
+void indexJoin(JoinInput& table1, const ColumnInfo& column1, JoinInput& table2, const ColumnInfo& column2, element_type op, std::vector<char>& row, ResultSink& sink, JoinStats& stats) {
+    size_t rows1 = approximateRows(table1);
+    size_t rows2 = approximateRows(table2);
+    bool buildTable1 = rows1 < rows2;
+    JoinInput& build = buildTable1 ? table1 : table2;
+    JoinInput& probe = buildTable1 ? table2 : table1;
+    size_t buildRows = buildTable1 ? rows1 : rows2;
+
+    // a wide build side that won't fit is read as keys and positions, and the rest of it read back for the rows that join
+    ColumnInfo buildColumn = buildTable1 ? column1 : column2;
+    std::unique_ptr<LateColumns> late;
+    if (lateMaterializable(build, buildRows, buildColumn)) {
+        late = std::make_unique<LateColumns>(build, buildColumn, buildTable1, probe.rowSize, sink, stats);
+        buildColumn = build.readKeyAndPosition(buildColumn);
+    }
+    JoinSides sides{buildTable1, buildColumn, buildTable1 ? column2 : column1, buildTable1 ? mirrored(op) : op,
+                    table1.rowSize, table2.rowSize, row, late ? *late : sink};
+
+    if (op != op_equals)
+        joinInMemory<SortedJoinKeys<Key>>(build, probe, sides);
+    // only two bool values, so partitioning can't split them
+    else if constexpr (std::is_same_v<Key, bool>)
+        joinInMemory<JoinHashTable<Key>>(build, probe, sides);
+    else
+        joinPartitioned<Key>(build, buildRows, probe, sides, 0, stats);
+    if (late)
+        late->flush();
+}
+
+// whether indexJoin() can run a join with this operator. != matches nearly every pair, so it's left to a nested loop
+inline bool indexJoinable(element_type op) {
+    return op == op_equals || op == op_less_than || op == op_less_than_equals || op == op_greater_than || op == op_greater_than_equals;
+}
+
+// indexJoin() on the columns' type, which validation made the same
+inline void indexJoin(JoinInput& table1, const ColumnInfo& column1, JoinInput& table2, const ColumnInfo& column2, element_type op, std::vector<char>& row, ResultSink& sink, JoinStats& stats) {
+    switch (column1.type) {
+        case int_literal: return indexJoin<int>(table1, column1, table2, column2, op, row, sink, stats);
+        case float_literal: return indexJoin<float>(table1, column1, table2, column2, op, row, sink, stats);
+        case chars_literal: return indexJoin<std::string_view>(table1, column1, table2, column2, op, row, sink, stats);
+        // validation only allows == and != on bools
+        case bool_literal: return indexJoin<bool>(table1, column1, table2, column2, op, row, sink, stats);
+        default:
+            throw QueryError() << "Error in indexJoin(). Somehow, column \"" << column1.name << "\" in table \"" << table1.table.t.name << "\" is not one of the literal types.\n";
+    }
+}
+
+// one on expr of a join of several tables: tables[table1]'s column1 op tables[table2]'s column2
+struct JoinCondition {
+    size_t table1;
+    const ColumnInfo* column1;
+    element_type op;
+    size_t table2;
+    const ColumnInfo* column2;
+};
+
+// lhs op rhs for two cells of Key values, given pointers to their null bytes. false if either is null
+template <typename Key>
+bool compareCells(const char* lhs, int lhsLength, element_type op, const char* rhs, int rhsLength) {
+    if (*lhs || *rhs)
+        return false;
+    return compareValues(op, joinKey<Key>(lhs, lhsLength), joinKey<Key>(rhs, rhsLength));
+}
+
+// compareCells() on the columns' type, which validation made the same
+inline bool compareCells(const char* lhs, const ColumnInfo& lhsColumn, element_type op, const char* rhs, const ColumnInfo& rhsColumn) {
+    switch (lhsColumn.type) {
+        case int_literal: return compareCells<int>(lhs, lhsColumn.charsLength, op, rhs, rhsColumn.charsLength);
+        case float_literal: return compareCells<float>(lhs, lhsColumn.charsLength, op, rhs, rhsColumn.charsLength);
+        case chars_literal: return compareCells<std::string_view>(lhs, lhsColumn.charsLength, op, rhs, rhsColumn.charsLength);
+        case bool_literal: return compareCells<bool>(lhs, lhsColumn.charsLength, op, rhs, rhsColumn.charsLength);
+        default:
+            throw QueryError() << "Error in compareCells(). Somehow, column \"" << lhsColumn.name << "\" is not one of the literal types.\n";
+    }
+}
+
+struct RowIndex;
+
+// one table a pipelined join adds to the rows joined so far: its live rows in memory, indexed on the column of the condition
+// that joins it to a table before it, and the rest of the conditions between it and the tables before it, checked on each match
+struct PipelineStep {
+    size_t table;
+    RowStore rows;
+    const ColumnInfo* column;
+    std::unique_ptr<RowIndex> index;
+    size_t boundTable;                  // the earlier table whose cell is looked up in index
+    const ColumnInfo* boundColumn;
+    element_type probeOp;               // the bound cell's value op a row's value
+    std::vector<JoinCondition> filters;
+};
+
+// a JoinHashTable, SortedJoinKeys, or ScanJoinKeys, whichever the operator needs, behind one interface for joinPipeline()
+struct RowIndex {
+    virtual ~RowIndex() = default;
+
+    // append to extended each joined row in partial, width rows long, with each row of step's table its bound row matches
+    // that passes step's filters. one virtual call per step and block, so the probes themselves inline
+    virtual void extend(const PipelineStep& step, const std::vector<const char*>& partial, size_t width, std::vector<const char*>& extended) const = 0;
+};
+
+template <typename Index>
+struct RowIndexOf : RowIndex {
+    Index index;
+
+    void extend(const PipelineStep& step, const std::vector<const char*>& partial, size_t width, std::vector<const char*>& extended) const override {
+        for (size_t p = 0; p < partial.size(); p += width) {
+            const char* bound = partial[p + step.boundTable];
+            index.probe(bound + step.boundColumn->offset, step.boundColumn->charsLength, step.probeOp, [&](uint32_t match) {
+                extended.insert(extended.end(), partial.begin() + p, partial.begin() + p + width);
+                const char** current = extended.data() + extended.size() - width;
+                current[step.table] = step.rows[match];
+                for (const JoinCondition& f : step.filters) {
+                    if (!compareCells(current[f.table1] + f.column1->offset, *f.column1, f.op, current[f.table2] + f.column2->offset, *f.column2)) {
+                        extended.resize(extended.size() - width);
+                        return;
+                    }
+                }
+            });
+        }
+    }
+};
+
+template <typename Key>
+std::unique_ptr<RowIndex> makeRowIndex(element_type op, const RowStore& rows, const ColumnInfo& column) {
+    std::unique_ptr<RowIndex> index;
+    if (op == op_equals) {
+        auto hashed = std::make_unique<RowIndexOf<JoinHashTable<Key>>>();
+        hashed->index.build(rows, column.offset, column.charsLength);
+        index = std::move(hashed);
+    }
+    else if (op == op_not_equals) {
+        auto scanned = std::make_unique<RowIndexOf<ScanJoinKeys<Key>>>();
+        scanned->index.build(rows, column.offset, column.charsLength);
+        index = std::move(scanned);
+    }
+    else {
+        auto sorted = std::make_unique<RowIndexOf<SortedJoinKeys<Key>>>();
+        sorted->index.build(rows, column.offset, column.charsLength);
+        index = std::move(sorted);
+    }
+    return index;
+}
+
+// the index of rows on column for probing with op, on the column's type
+inline std::unique_ptr<RowIndex> makeRowIndex(element_type op, const RowStore& rows, const ColumnInfo& column) {
+    switch (column.type) {
+        case int_literal: return makeRowIndex<int>(op, rows, column);
+        case float_literal: return makeRowIndex<float>(op, rows, column);
+        case chars_literal: return makeRowIndex<std::string_view>(op, rows, column);
+        case bool_literal: return makeRowIndex<bool>(op, rows, column);
+        default:
+            throw QueryError() << "Error in makeRowIndex(). Somehow, column \"" << column.name << "\" is not one of the literal types.\n";
+    }
+}
+
+// the rows one thread has joined so far, for a block of the streamed table's rows at a time
+// each step extends all of them before the next step starts, so one index is probed for the whole block at once
+struct PipelineJoiner {
+    const std::vector<PipelineStep>& steps;
+    const std::vector<unsigned int>& offsets;       // of each table's row in a joined row
+    const std::vector<unsigned int>& rowSizes;
+    unsigned int joinedRowSize;
+    size_t stream;
+    std::vector<const char*> partial;               // a row of each table joined so far, rowSizes.size() pointers per joined row
+    std::vector<const char*> extended;
+
+    PipelineJoiner(const std::vector<PipelineStep>& steps, const std::vector<unsigned int>& offsets, const std::vector<unsigned int>& rowSizes,
+                   unsigned int joinedRowSize, size_t stream)
+        : steps(steps), offsets(offsets), rowSizes(rowSizes), joinedRowSize(joinedRowSize), stream(stream) {}
+
+    // append every joined row the live rows of a block of count streamed rows, rowSize bytes apart, extend to
+    void join(const char* block, size_t count, unsigned int rowSize, std::vector<char>& joined) {
+        size_t width = rowSizes.size();
+        partial.clear();
+        for (size_t i = 0; i < count; ++i) {
+            if (block[i * rowSize])
+                continue;
+            partial.resize(partial.size() + width, nullptr);
+            partial[partial.size() - width + stream] = block + i * rowSize;
+        }
+
+        for (const PipelineStep& step : steps) {
+            extended.clear();
+            step.index->extend(step, partial, width, extended);
+            partial.swap(extended);
+        }
+
+        size_t rows = partial.size() / width;
+        size_t start = joined.size();
+        joined.resize(start + rows * joinedRowSize);
+        for (size_t r = 0; r < rows; ++r) {
+            char* row = joined.data() + start + r * joinedRowSize;
+            row[0] = '\0';
+            for (size_t t = 0; t < width; ++t)
+                std::copy(partial[r * width + t] + 1, partial[r * width + t] + rowSizes[t], row + offsets[t]);
+        }
+    }
+};
+
+// a join of several tables on conditions, at least one joining each table to the rest, as one pipeline with no intermediate results.
+// the table with the most rows is read through once, and the rest are read into memory and indexed, then joined onto its rows a block
+// at a time, one table after another, each through the index of the condition that joins it to a table before it.
+// the order is picked greedily from the tables' sizes: next is the smallest table a condition joins to the tables so far, preferring ones
+// an == joins, so the fewest partial rows are carried to each later step. joined rows are each table's row without its delete byte,
+// in the order tables names them, and come out in the order the largest table's rows are read
+inline void joinPipeline(const std::vector<JoinInput*>& tables, const std::vector<JoinCondition>& conditions, ResultSink& sink) {
+    std::vector<size_t> sizes;
+    std::vector<unsigned int> offsets;
+    std::vector<unsigned int> rowSizes;
+    unsigned int joinedRowSize = 1;
+    for (JoinInput* table : tables) {
+        sizes.push_back(approximateRows(*table));
+        offsets.push_back(joinedRowSize);
+        rowSizes.push_back(table->rowSize);
+        joinedRowSize += table->rowSize - 1;
+    }
+
+    size_t stream = std::max_element(sizes.begin(), sizes.end()) - sizes.begin();
+    std::vector<bool> joined(tables.size(), false);
+    joined[stream] = true;
+    std::vector<PipelineStep> steps;
+    for (size_t added = 1; added < tables.size(); ++added) {
+        // the condition each table not joined yet would be looked up on, the first == one or else the first one
+        const JoinCondition* best = nullptr;
+        size_t bestTable = 0;
+        for (const JoinCondition& c : conditions) {
+            if (joined[c.table1] == joined[c.table2])
+                continue;
+            size_t table = joined[c.table1] ? c.table2 : c.table1;
+            bool better = !best || (c.op == op_equals && best->op != op_equals)
+                       || ((c.op == op_equals) == (best->op == op_equals) && sizes[table] < sizes[bestTable]);
+            if (better) {
+                best = &c;
+                bestTable = table;
+            }
+        }
+        if (!best)
+            throw QueryError() << "Error in joinPipeline(). Somehow, table \"" << tables[stream]->table.t.name << "\" isn't joined to every other table.\n";
+
+        PipelineStep step;
+        step.table = bestTable;
+        bool boundFirst = best->table2 == bestTable;
+        step.column = boundFirst ? best->column2 : best->column1;
+        step.boundTable = boundFirst ? best->table1 : best->table2;
+        step.boundColumn = boundFirst ? best->column1 : best->column2;
+        step.probeOp = boundFirst ? best->op : mirrored(best->op);
+        for (const JoinCondition& c : conditions)
+            if (&c != best && ((c.table1 == bestTable && joined[c.table2]) || (c.table2 == bestTable && joined[c.table1])))
+                step.filters.push_back(c);
+        joined[bestTable] = true;
+        steps.push_back(std::move(step));
+    }
+
+    for (PipelineStep& step : steps) {
+        step.rows.read(*tables[step.table]);
+        // nothing to join to
+        if (step.rows.size() == 0)
+            return;
+        step.index = makeRowIndex(step.probeOp, step.rows, *step.column);
+    }
+
+    unsigned int streamRowSize = tables[stream]->rowSize;
+    joinBlocks(*tables[stream], joinedRowSize, sink, [&] {
+        return [&, joiner = PipelineJoiner(steps, offsets, rowSizes, joinedRowSize, stream)](const char* block, size_t count, std::vector<char>& joined) mutable {
+            joiner.join(block, count, streamRowSize, joined);
+        };
+    });
+}
+
+#endif
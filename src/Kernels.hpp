@@ -0,0 +1,252 @@
+// Kernels.hpp
+
+#ifndef KERNELS
+#define KERNELS
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include "element_type.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define KERNELS_X86
+#endif
+
+// column op literal over a block of rows for int and float columns, the filters a where clause spends most of its time in
+// rows are rowSize bytes apart and offset is the column's null byte, the same layout Table::readBlock() reads
+// the result is a bitmask: bit i % 64 of bits[i / 64] is set when row i isn't null and its value op literal is true,
+// so bits needs room for (count + 63) / 64 words
+//
+// each comparison has a scalar, an SSE2, and an AVX2 version. compareInts() and compareFloats() use bestKernelSet() unless told otherwise
+// the SIMD versions are compiled with target attributes, so no build flags are needed and the same binary still runs on a cpu without them
+
+enum class KernelSet {
+    Scalar,
+    Sse2,
+    Avx2
+};
+
+inline const char* kernelSetName(KernelSet set) {
+    switch (set) {
+        case KernelSet::Scalar: return "scalar";
+        case KernelSet::Sse2: return "sse2";
+        case KernelSet::Avx2: return "avx2";
+    }
+    return "";
+}
+
+// AVX2 if the cpu has it, checked once. rows are strided, and without a gather SSE2 has to load each lane on its own,
+// which bench/kernels.cpp measures as slower than scalar, so it's never picked on its own
+inline KernelSet bestKernelSet() {
+#ifdef KERNELS_X86
+    static const KernelSet best = __builtin_cpu_supports("avx2") ? KernelSet::Avx2 : KernelSet::Scalar;
+    return best;
+#else
+    return KernelSet::Scalar;
+#endif
+}
+
+inline size_t bitmaskWords(size_t count) {
+    return (count + 63) / 64;
+}
+
+inline bool bitIsSet(const uint64_t* bits, size_t i) {
+    return (bits[i / 64] >> (i % 64)) & 1;
+}
+
+template <element_type Op, typename T>
+inline bool compareWith(T lhs, T rhs) {
+    if constexpr (Op == op_equals) return lhs == rhs;
+    else if constexpr (Op == op_not_equals) return lhs != rhs;
+    else if constexpr (Op == op_less_than) return lhs < rhs;
+    else if constexpr (Op == op_less_than_equals) return lhs <= rhs;
+    else if constexpr (Op == op_greater_than) return lhs > rhs;
+    else return lhs >= rhs;
+}
+
+// rows [first, count), and the tail the SIMD versions leave over
+template <element_type Op, typename T>
+inline void compareScalar(const char* rows, size_t rowSize, size_t first, size_t count, int offset, T literal, uint64_t* bits) {
+    for (size_t i = first; i < count; ++i) {
+        const char* cell = rows + i * rowSize + offset;
+        T value;
+        std::memcpy(&value, cell + 1, sizeof(value));
+        bool pass = !*cell && compareWith<Op>(value, literal);
+        bits[i / 64] |= uint64_t(pass) << (i % 64);
+    }
+}
+
+#ifdef KERNELS_X86
+
+// the rows are strided, so SSE2 loads each lane on its own and compares four at a time
+template <element_type Op>
+__attribute__((target("sse2")))
+inline void compareIntsSse2(const char* rows, size_t rowSize, size_t count, int offset, int literal, uint64_t* bits) {
+    const __m128i literals = _mm_set1_epi32(literal);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const char* cell = rows + i * rowSize + offset;
+        alignas(16) int32_t values[4];
+        alignas(16) int32_t nulls[4];
+        for (int lane = 0; lane < 4; ++lane) {
+            std::memcpy(&values[lane], cell + lane * rowSize + 1, sizeof(int32_t));
+            nulls[lane] = cell[lane * rowSize];
+        }
+        __m128i v = _mm_load_si128(reinterpret_cast<const __m128i*>(values));
+        __m128i notNull = _mm_cmpeq_epi32(_mm_load_si128(reinterpret_cast<const __m128i*>(nulls)), _mm_setzero_si128());
+
+        __m128i pass;
+        if constexpr (Op == op_equals) pass = _mm_cmpeq_epi32(v, literals);
+        else if constexpr (Op == op_not_equals) pass = _mm_xor_si128(_mm_cmpeq_epi32(v, literals), _mm_set1_epi32(-1));
+        else if constexpr (Op == op_less_than) pass = _mm_cmplt_epi32(v, literals);
+        else if constexpr (Op == op_less_than_equals) pass = _mm_xor_si128(_mm_cmpgt_epi32(v, literals), _mm_set1_epi32(-1));
+        else if constexpr (Op == op_greater_than) pass = _mm_cmpgt_epi32(v, literals);
+        else pass = _mm_xor_si128(_mm_cmplt_epi32(v, literals), _mm_set1_epi32(-1));
+
+        uint64_t mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_and_si128(pass, notNull)));
+        bits[i / 64] |= mask << (i % 64);
+    }
+    compareScalar<Op>(rows, rowSize, i, count, offset, literal, bits);
+}
+
+template <element_type Op>
+__attribute__((target("sse2")))
+inline void compareFloatsSse2(const char* rows, size_t rowSize, size_t count, int offset, float literal, uint64_t* bits) {
+    const __m128 literals = _mm_set1_ps(literal);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const char* cell = rows + i * rowSize + offset;
+        alignas(16) float values[4];
+        alignas(16) int32_t nulls[4];
+        for (int lane = 0; lane < 4; ++lane) {
+            std::memcpy(&values[lane], cell + lane * rowSize + 1, sizeof(float));
+            nulls[lane] = cell[lane * rowSize];
+        }
+        __m128 v = _mm_load_ps(values);
+        __m128i notNull = _mm_cmpeq_epi32(_mm_load_si128(reinterpret_cast<const __m128i*>(nulls)), _mm_setzero_si128());
+
+        // cmpneq is true for NaN, the same as !=. the others are false for it
+        __m128 pass;
+        if constexpr (Op == op_equals) pass = _mm_cmpeq_ps(v, literals);
+        else if constexpr (Op == op_not_equals) pass = _mm_cmpneq_ps(v, literals);
+        else if constexpr (Op == op_less_than) pass = _mm_cmplt_ps(v, literals);
+        else if constexpr (Op == op_less_than_equals) pass = _mm_cmple_ps(v, literals);
+        else if constexpr (Op == op_greater_than) pass = _mm_cmpgt_ps(v, literals);
+        else pass = _mm_cmpge_ps(v, literals);
+
+        uint64_t mask = _mm_movemask_ps(_mm_and_ps(pass, _mm_castsi128_ps(notNull)));
+        bits[i / 64] |= mask << (i % 64);
+    }
+    compareScalar<Op>(rows, rowSize, i, count, offset, literal, bits);
+}
+
+// AVX2 gathers eight strided cells at once. the null byte is gathered as the low byte of a 32 bit load
+template <element_type Op>
+__attribute__((target("avx2")))
+inline void compareIntsAvx2(const char* rows, size_t rowSize, size_t count, int offset, int literal, uint64_t* bits) {
+    const __m256i literals = _mm256_set1_epi32(literal);
+    const __m256i strides = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(rowSize));
+    const __m256i lowByte = _mm256_set1_epi32(0xFF);
+    const __m256i ones = _mm256_set1_epi32(-1);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const char* cell = rows + i * rowSize + offset;
+        __m256i nulls = _mm256_and_si256(_mm256_i32gather_epi32(reinterpret_cast<const int*>(cell), strides, 1), lowByte);
+        __m256i v = _mm256_i32gather_epi32(reinterpret_cast<const int*>(cell + 1), strides, 1);
+        __m256i notNull = _mm256_cmpeq_epi32(nulls, _mm256_setzero_si256());
+
+        __m256i pass;
+        if constexpr (Op == op_equals) pass = _mm256_cmpeq_epi32(v, literals);
+        else if constexpr (Op == op_not_equals) pass = _mm256_xor_si256(_mm256_cmpeq_epi32(v, literals), ones);
+        else if constexpr (Op == op_less_than) pass = _mm256_cmpgt_epi32(literals, v);
+        else if constexpr (Op == op_less_than_equals) pass = _mm256_xor_si256(_mm256_cmpgt_epi32(v, literals), ones);
+        else if constexpr (Op == op_greater_than) pass = _mm256_cmpgt_epi32(v, literals);
+        else pass = _mm256_xor_si256(_mm256_cmpgt_epi32(literals, v), ones);
+
+        uint64_t mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_and_si256(pass, notNull)));
+        bits[i / 64] |= mask << (i % 64);
+    }
+    compareScalar<Op>(rows, rowSize, i, count, offset, literal, bits);
+}
+
+template <element_type Op>
+__attribute__((target("avx2")))
+inline void compareFloatsAvx2(const char* rows, size_t rowSize, size_t count, int offset, float literal, uint64_t* bits) {
+    const __m256 literals = _mm256_set1_ps(literal);
+    const __m256i strides = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(rowSize));
+    const __m256i lowByte = _mm256_set1_epi32(0xFF);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const char* cell = rows + i * rowSize + offset;
+        __m256i nulls = _mm256_and_si256(_mm256_i32gather_epi32(reinterpret_cast<const int*>(cell), strides, 1), lowByte);
+        __m256 v = _mm256_i32gather_ps(reinterpret_cast<const float*>(cell + 1), strides, 1);
+        __m256i notNull = _mm256_cmpeq_epi32(nulls, _mm256_setzero_si256());
+
+        // ordered comparisons are false for NaN, unordered != is true for it, the same as the scalar operators
+        __m256 pass;
+        if constexpr (Op == op_equals) pass = _mm256_cmp_ps(v, literals, _CMP_EQ_OQ);
+        else if constexpr (Op == op_not_equals) pass = _mm256_cmp_ps(v, literals, _CMP_NEQ_UQ);
+        else if constexpr (Op == op_less_than) pass = _mm256_cmp_ps(v, literals, _CMP_LT_OQ);
+        else if constexpr (Op == op_less_than_equals) pass = _mm256_cmp_ps(v, literals, _CMP_LE_OQ);
+        else if constexpr (Op == op_greater_than) pass = _mm256_cmp_ps(v, literals, _CMP_GT_OQ);
+        else pass = _mm256_cmp_ps(v, literals, _CMP_GE_OQ);
+
+        uint64_t mask = _mm256_movemask_ps(_mm256_and_ps(pass, _mm256_castsi256_ps(notNull)));
+        bits[i / 64] |= mask << (i % 64);
+    }
+    compareScalar<Op>(rows, rowSize, i, count, offset, literal, bits);
+}
+
+#endif
+
+template <element_type Op>
+inline void compareIntsWith(KernelSet set, const char* rows, size_t rowSize, size_t count, int offset, int literal, uint64_t* bits) {
+    switch (set) {
+#ifdef KERNELS_X86
+        case KernelSet::Avx2: compareIntsAvx2<Op>(rows, rowSize, count, offset, literal, bits); return;
+        case KernelSet::Sse2: compareIntsSse2<Op>(rows, rowSize, count, offset, literal, bits); return;
+#endif
+        default: compareScalar<Op>(rows, rowSize, 0, count, offset, literal, bits);
+    }
+}
+
+template <element_type Op>
+inline void compareFloatsWith(KernelSet set, const char* rows, size_t rowSize, size_t count, int offset, float literal, uint64_t* bits) {
+    switch (set) {
+#ifdef KERNELS_X86
+        case KernelSet::Avx2: compareFloatsAvx2<Op>(rows, rowSize, count, offset, literal, bits); return;
+        case KernelSet::Sse2: compareFloatsSse2<Op>(rows, rowSize, count, offset, literal, bits); return;
+#endif
+        default: compareScalar<Op>(rows, rowSize, 0, count, offset, literal, bits);
+    }
+}
+
+// int column op literal over count rows, e.g. compareInts(block, rowSize, count, column.offset, op_less_than, 10, bits)
+inline void compareInts(const char* rows, size_t rowSize, size_t count, int offset, element_type op, int literal, uint64_t* bits,
+                        KernelSet set = bestKernelSet()) {
+    std::memset(bits, 0, bitmaskWords(count) * sizeof(uint64_t));
+    switch (op) {
+        case op_equals: compareIntsWith<op_equals>(set, rows, rowSize, count, offset, literal, bits); break;
+        case op_not_equals: compareIntsWith<op_not_equals>(set, rows, rowSize, count, offset, literal, bits); break;
+        case op_less_than: compareIntsWith<op_less_than>(set, rows, rowSize, count, offset, literal, bits); break;
+        case op_less_than_equals: compareIntsWith<op_less_than_equals>(set, rows, rowSize, count, offset, literal, bits); break;
+        case op_greater_than: compareIntsWith<op_greater_than>(set, rows, rowSize, count, offset, literal, bits); break;
+        case op_greater_than_equals: compareIntsWith<op_greater_than_equals>(set, rows, rowSize, count, offset, literal, bits); break;
+    }
+}
+
+inline void compareFloats(const char* rows, size_t rowSize, size_t count, int offset, element_type op, float literal, uint64_t* bits,
+                          KernelSet set = bestKernelSet()) {
+    std::memset(bits, 0, bitmaskWords(count) * sizeof(uint64_t));
+    switch (op) {
+        case op_equals: compareFloatsWith<op_equals>(set, rows, rowSize, count, offset, literal, bits); break;
+        case op_not_equals: compareFloatsWith<op_not_equals>(set, rows, rowSize, count, offset, literal, bits); break;
+        case op_less_than: compareFloatsWith<op_less_than>(set, rows, rowSize, count, offset, literal, bits); break;
+        case op_less_than_equals: compareFloatsWith<op_less_than_equals>(set, rows, rowSize, count, offset, literal, bits); break;
+        case op_greater_than: compareFloatsWith<op_greater_than>(set, rows, rowSize, count, offset, literal, bits); break;
+        case op_greater_than_equals: compareFloatsWith<op_greater_than_equals>(set, rows, rowSize, count, offset, literal, bits); break;
+    }
+}
+
+#endif
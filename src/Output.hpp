@@ -0,0 +1,349 @@
+// Output.hpp
+
+#ifndef OUTPUT
+#define OUTPUT
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstring>
+#include <charconv>
+#include "TableInfo.hpp"
+#include "Batch.hpp"
+#include "QueryError.hpp"
+
+#define UNDERLINE "\033[4m"
+#define CLOSEUNDERLINE "\033[0m"
+
+// one large buffer that every row is formatted into, written to out only when it fills up or a result ends
+// numbers go through std::to_chars straight into the buffer, so formatting a cell never allocates
+struct OutputBuffer {
+    static const size_t CAPACITY = 1 << 20;
+
+    std::ostream& out;
+    std::vector<char> buffer;
+    size_t used = 0;
+
+    OutputBuffer(std::ostream& out) : out(out), buffer(CAPACITY) {}
+
+    ~OutputBuffer() {
+        flush();
+    }
+
+    void flush() {
+        out.write(buffer.data(), used);
+        out.flush();
+        used = 0;
+    }
+
+    // room for at least n more bytes, starting at the returned pointer
+    char* reserve(size_t n) {
+        if (used + n > buffer.size()) {
+            flush();
+            if (n > buffer.size())
+                buffer.resize(n);
+        }
+        return buffer.data() + used;
+    }
+
+    // mark everything up to end as written, after filling in what reserve() returned
+    void commit(char* end) {
+        used = end - buffer.data();
+    }
+
+    void append(const char* data, size_t n) {
+        char* p = reserve(n);
+        std::memcpy(p, data, n);
+        used += n;
+    }
+
+    void append(const char* str) {
+        append(str, std::strlen(str));
+    }
+
+    void append(char c) {
+        *reserve(1) = c;
+        ++used;
+    }
+
+    void appendSpaces(size_t n) {
+        char* p = reserve(n);
+        std::memset(p, ' ', n);
+        used += n;
+    }
+
+    void appendInt(int value) {
+        char* p = reserve(16);
+        commit(std::to_chars(p, p + 16, value).ptr);
+    }
+
+    // shortest text that reads back as the same float
+    void appendFloat(float value) {
+        char* p = reserve(64);
+        commit(std::to_chars(p, p + 64, value).ptr);
+    }
+};
+
+// length of a chars value without its '\0' padding
+inline size_t charsValueLength(const char* value, size_t charsLength) {
+    const char* end = static_cast<const char*>(std::memchr(value, '\0', charsLength));
+    return end ? end - value : charsLength;
+}
+
+// the command line output: a statement line, underlined column names, then one line per row with each cell right aligned
+struct PrettyPrinter : BatchConsumer {
+    OutputBuffer& buffer;
+
+    PrettyPrinter(OutputBuffer& buffer) : buffer(buffer) {}
+
+    // right align text of length n in width, then a space
+    void appendCell(const char* text, size_t n, size_t width) {
+        if (n < width)
+            buffer.appendSpaces(width - n);
+        buffer.append(text, n);
+        buffer.append(' ');
+    }
+
+    void begin(const std::string& statement, const std::string& tables, const TableInfo& layout) override {
+        // output statement. a select's statement runs into its table names' color, as it always has
+        bool select = statement == "select from";
+        buffer.append("\n\033[0;34m$ ");
+        buffer.append(statement.data(), statement.length());
+        buffer.append(select ? " \033[0;32m" : "\033[0m \033[0;32m");
+        buffer.append(tables.data(), tables.length());
+        buffer.append("\033[0m\n");
+
+        // output column names, underlined once for a join and once per column otherwise
+        bool join = statement == "join";
+        buffer.append(UNDERLINE);
+        for (const ColumnInfo& column : layout.columns) {
+            if (!join)
+                buffer.append(UNDERLINE);
+            appendCell(column.name.data(), column.name.length(), column.outputWidth);
+        }
+        buffer.append('\n');
+        buffer.append(CLOSEUNDERLINE);
+    }
+
+    void consume(const Batch& batch) override {
+        char text[64];
+        for (size_t row = 0; row < batch.size; ++row) {
+            for (const ColumnVector& column : batch.columns) {
+                size_t width = column.info.outputWidth;
+
+                if (column.nulls[row]) {
+                    appendCell("$null", 5, width);
+                    continue;
+                }
+
+                switch (column.info.type) {
+                    case int_literal:
+                        appendCell(text, std::to_chars(text, text + sizeof(text), column.ints[row]).ptr - text, width);
+                        break;
+                    // six decimal places, the same as std::to_string
+                    case float_literal:
+                        appendCell(text, std::to_chars(text, text + sizeof(text), column.floats[row], std::chars_format::fixed, 6).ptr - text, width);
+                        break;
+                    case chars_literal: {
+                        const char* value = column.chars.data() + row * column.info.charsLength;
+                        appendCell(value, charsValueLength(value, column.info.charsLength), width);
+                        break;
+                    }
+                    case bool_literal:
+                        if (column.bools[row])
+                            appendCell("true", 4, width);
+                        else
+                            appendCell("false", 5, width);
+                        break;
+                }
+            }
+            buffer.append('\n');
+        }
+    }
+
+    void end() override {
+        buffer.flush();
+    }
+};
+
+// comma or tab separated values, one header line of column names and then one line per row
+// csv quotes chars values that need it and leaves nulls empty. tsv escapes tabs, newlines and backslashes, and writes nulls as \N
+struct DelimitedWriter : BatchConsumer {
+    OutputBuffer& buffer;
+    char delimiter;
+
+    DelimitedWriter(OutputBuffer& buffer, char delimiter) : buffer(buffer), delimiter(delimiter) {}
+
+    void appendChars(const char* value, size_t n) {
+        // csv
+        if (delimiter == ',') {
+            bool needsQuotes = false;
+            for (size_t i = 0; i < n && !needsQuotes; ++i)
+                needsQuotes = value[i] == ',' || value[i] == '"' || value[i] == '\n' || value[i] == '\r';
+            if (!needsQuotes) {
+                buffer.append(value, n);
+                return;
+            }
+            buffer.append('"');
+            for (size_t i = 0; i < n; ++i) {
+                if (value[i] == '"')
+                    buffer.append('"');
+                buffer.append(value[i]);
+            }
+            buffer.append('"');
+            return;
+        }
+
+        // tsv
+        for (size_t i = 0; i < n; ++i) {
+            switch (value[i]) {
+                case '\t': buffer.append("\\t", 2); break;
+                case '\n': buffer.append("\\n", 2); break;
+                case '\r': buffer.append("\\r", 2); break;
+                case '\\': buffer.append("\\\\", 2); break;
+                default: buffer.append(value[i]);
+            }
+        }
+    }
+
+    void begin(const std::string& statement, const std::string& tables, const TableInfo& layout) override {
+        for (size_t i = 0; i < layout.columns.size(); ++i) {
+            if (i != 0)
+                buffer.append(delimiter);
+            appendChars(layout.columns[i].name.data(), layout.columns[i].name.length());
+        }
+        buffer.append('\n');
+    }
+
+    void consume(const Batch& batch) override {
+        for (size_t row = 0; row < batch.size; ++row) {
+            for (size_t i = 0; i < batch.columns.size(); ++i) {
+                const ColumnVector& column = batch.columns[i];
+                if (i != 0)
+                    buffer.append(delimiter);
+
+                if (column.nulls[row]) {
+                    if (delimiter != ',')
+                        buffer.append("\\N", 2);
+                    continue;
+                }
+
+                switch (column.info.type) {
+                    case int_literal:
+                        buffer.appendInt(column.ints[row]);
+                        break;
+                    case float_literal:
+                        buffer.appendFloat(column.floats[row]);
+                        break;
+                    case chars_literal: {
+                        const char* value = column.chars.data() + row * column.info.charsLength;
+                        appendChars(value, charsValueLength(value, column.info.charsLength));
+                        break;
+                    }
+                    case bool_literal:
+                        if (column.bools[row])
+                            buffer.append("true", 4);
+                        else
+                            buffer.append("false", 5);
+                        break;
+                }
+            }
+            buffer.append('\n');
+        }
+    }
+
+    void end() override {
+        buffer.flush();
+    }
+};
+
+// the column vectors themselves, for another program to read back without parsing text. all integers are little endian
+//     result: uint32 column count
+//             per column: uint8 type (as in a table header), uint8 chars length, uint8 name length, name
+//             per batch:  uint32 row count, then per column: one null byte per row, then the values
+//                         (4 bytes per int or float, 1 per bool, chars length per chars)
+//             uint32 0
+struct BinaryWriter : BatchConsumer {
+    OutputBuffer& buffer;
+
+    BinaryWriter(OutputBuffer& buffer) : buffer(buffer) {}
+
+    void appendUint32(uint32_t value) {
+        buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void begin(const std::string& statement, const std::string& tables, const TableInfo& layout) override {
+        appendUint32(layout.columns.size());
+        for (const ColumnInfo& column : layout.columns) {
+            buffer.append(columnTypeToByte(column.type));
+            buffer.append(static_cast<char>(column.type == chars_literal ? column.charsLength : 0));
+            buffer.append(static_cast<char>(column.name.length()));
+            buffer.append(column.name.data(), column.name.length());
+        }
+    }
+
+    void consume(const Batch& batch) override {
+        appendUint32(batch.size);
+        for (const ColumnVector& column : batch.columns) {
+            buffer.append(reinterpret_cast<const char*>(column.nulls.data()), batch.size);
+            switch (column.info.type) {
+                case int_literal:
+                    buffer.append(reinterpret_cast<const char*>(column.ints.data()), batch.size * sizeof(int));
+                    break;
+                case float_literal:
+                    buffer.append(reinterpret_cast<const char*>(column.floats.data()), batch.size * sizeof(float));
+                    break;
+                case bool_literal:
+                    buffer.append(reinterpret_cast<const char*>(column.bools.data()), batch.size);
+                    break;
+                case chars_literal:
+                    buffer.append(column.chars.data(), batch.size * column.info.charsLength);
+                    break;
+            }
+        }
+    }
+
+    void end() override {
+        appendUint32(0);
+        buffer.flush();
+    }
+};
+
+// writes results to out in one of the formats above, switching whenever an output statement asks it to
+struct FormattedOutput : BatchConsumer {
+    OutputBuffer buffer;
+    std::unique_ptr<BatchConsumer> writer;
+
+    FormattedOutput(std::ostream& out, const std::string& format = "pretty") : buffer(out) {
+        setFormat(format);
+    }
+
+    // "pretty", "csv", "tsv", or "binary"
+    void setFormat(const std::string& format) override {
+        if (format == "pretty")
+            writer = std::make_unique<PrettyPrinter>(buffer);
+        else if (format == "csv")
+            writer = std::make_unique<DelimitedWriter>(buffer, ',');
+        else if (format == "tsv")
+            writer = std::make_unique<DelimitedWriter>(buffer, '\t');
+        else if (format == "binary")
+            writer = std::make_unique<BinaryWriter>(buffer);
+        else
+            throw QueryError() << "Unknown output format \"" << format << "\".\n";
+    }
+
+    void begin(const std::string& statement, const std::string& tables, const TableInfo& layout) override {
+        writer->begin(statement, tables, layout);
+    }
+
+    void consume(const Batch& batch) override {
+        writer->consume(batch);
+    }
+
+    void end() override {
+        writer->end();
+    }
+};
+
+#endif
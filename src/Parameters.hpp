@@ -0,0 +1,105 @@
+// Parameters.hpp
+
+#ifndef PARAMETERS
+#define PARAMETERS
+
+#include <map>
+#include <vector>
+#include <string>
+#include <functional>
+#include "element_type.hpp"
+#include "QueryError.hpp"
+
+// a ?1, ?2, ... placeholder in a prepared statement
+struct Parameter {
+    element_type type = kw_null;     // the literal type of the column it is compared to or written into
+    int charsLength = 0;             // longest chars value allowed, 0 when only compared against
+    bool inComparison = false;       // compared against in a where clause, so it can't be null
+
+    // the bound value, kept as the text of the equivalent literal so inserts and updates can use it like one
+    bool bound = false;
+    element_type boundType = kw_null; // type, or kw_null
+    std::string value;
+
+    // set by compileProgram(), one for every comparison in a program that compares against this placeholder
+    std::vector<std::function<void(const std::string&)>> binders;
+};
+
+// the placeholders of one statement and their values
+// the validator declares each one, compileProgram() registers binders for the comparisons that use it,
+// and bind() stores a value and writes it into those comparisons, so a program never has to be recompiled for new values
+struct Parameters {
+    std::map<int, Parameter> placeholders;
+
+    // called by the validator for each use of ?index
+    void declare(int index, element_type type, int charsLength, bool inComparison) {
+        auto found = placeholders.find(index);
+        if (found != placeholders.end() && found->second.type != type) {
+            throw QueryError() << "Validator error. Parameter ?" << index << " is used as both " << tokenTypeToString(found->second.type)
+                               << " and " << tokenTypeToString(type) << ".\n";
+        }
+
+        Parameter& p = placeholders[index];
+        p.type = type;
+        if (charsLength != 0 && (p.charsLength == 0 || charsLength < p.charsLength))
+            p.charsLength = charsLength;
+        p.inComparison = p.inComparison || inComparison;
+    }
+
+    // bind a literal to ?index, e.g. bind(1, int_literal, "42") or bind(2, kw_null, "")
+    void bind(int index, element_type type, const std::string& value) {
+        auto found = placeholders.find(index);
+        if (found == placeholders.end()) {
+            throw QueryError() << "Statement has no parameter ?" << index << ".\n";
+        }
+        Parameter& p = found->second;
+
+        if (type == kw_null && p.inComparison) {
+            throw QueryError() << "Parameter ?" << index << " is compared against in a where clause and cannot be null. Use == null instead.\n";
+        }
+        if (type != kw_null && type != p.type) {
+            throw QueryError() << "Parameter ?" << index << " is of type " << tokenTypeToString(p.type) << ", but "
+                               << tokenTypeToString(type) << ' ' << value << " was bound to it.\n";
+        }
+        if (type == chars_literal && p.charsLength != 0 && value.length() > p.charsLength) {
+            throw QueryError() << "Parameter ?" << index << " can be at most " << p.charsLength << " character(s).\n";
+        }
+
+        p.bound = true;
+        p.boundType = type;
+        p.value = value;
+        for (auto& binder : p.binders)
+            binder(value);
+    }
+
+    // called by compileProgram() for each comparison against ?index. a value that is already bound is applied right away
+    void addBinder(int index, std::function<void(const std::string&)> binder) {
+        Parameter& p = placeholders[index];
+        if (p.bound)
+            binder(p.value);
+        p.binders.push_back(binder);
+    }
+
+    // drop every binder, before the statement's programs are recompiled
+    void clearBinders() {
+        for (auto& [index, p] : placeholders)
+            p.binders.clear();
+    }
+
+    // the value bound to ?index, for inserts and updates
+    const Parameter& get(int index) const {
+        auto found = placeholders.find(index);
+        if (found == placeholders.end() || !found->second.bound) {
+            throw QueryError() << "Parameter ?" << index << " has no value bound to it.\n";
+        }
+        return found->second;
+    }
+
+    // every placeholder must have a value before a statement runs
+    void requireBound() const {
+        for (const auto& [index, p] : placeholders)
+            get(index);
+    }
+};
+
+#endif
@@ -0,0 +1,30 @@
+// QueryError.hpp
+
+#ifndef QUERYERROR
+#define QUERYERROR
+
+#include <exception>
+#include <sstream>
+#include <string>
+
+// thrown by the tokenizer, parser, validator, and executor instead of printing and calling exit(1)
+// the message is built up with <<, the same way it used to be written to std::cout:
+//     throw QueryError() << "Validator error. Table \"" << tableName << "\" doesn't exist.\n";
+// the command line program prints what() and exits, the library turns it into a femtoql::Status
+struct QueryError : std::exception {
+    std::string message;
+
+    template <typename T>
+    QueryError& operator<<(const T& value) {
+        std::ostringstream s;
+        s << value;
+        message += s.str();
+        return *this;
+    }
+
+    const char* what() const noexcept override {
+        return message.c_str();
+    }
+};
+
+#endif
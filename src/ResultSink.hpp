@@ -0,0 +1,26 @@
+// ResultSink.hpp
+
+#ifndef RESULTSINK
+#define RESULTSINK
+
+#include <string>
+#include "TableInfo.hpp"
+
+// selections, joins, and bag operations hand each resulting row to a ResultSink instead of writing it to std::cout
+// a row is laid out exactly like a row in a table file: the delete byte, then each column's null byte and value at its offset in the layout
+struct ResultSink {
+    virtual ~ResultSink() = default;
+
+    // called once before any rows, e.g. begin("select from", "t", layout)
+    virtual void begin(const std::string& statement, const std::string& tables, const TableInfo& layout) = 0;
+
+    virtual void row(const char* rowBytes) = 0;
+
+    // called once after the last row
+    virtual void end() {}
+
+    // an output statement, e.g. setFormat("csv"), for the results that follow. sinks that don't print ignore it
+    virtual void setFormat(const std::string& format) {}
+};
+
+#endif
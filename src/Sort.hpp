@@ -0,0 +1,260 @@
+// Sort.hpp
+
+#ifndef SORT
+#define SORT
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <algorithm>
+#include <queue>
+#include <cstring>
+#include <cstdint>
+#include <cstdio>
+#include "TableInfo.hpp"
+#include "ResultSink.hpp"
+#include "Batch.hpp"
+#include "Join.hpp"
+
+// an order clause sorts this many bytes of rows in memory at a time, each batch spilled as a sorted run once there's more than one. see SortSink
+size_t SORT_MEMORY_BUDGET = size_t(1) << 30;
+
+// runs merged at once, past which merge passes combine runs into longer ones until there are few enough
+const size_t MAX_MERGE_RUNS = 64;
+
+// how much an order clause spilled to disk, for diagnostics
+struct SortStats {
+    size_t runs = 0;            // sorted runs spilled before merging, none when every row fit in memory
+    size_t spilledRows = 0;
+    size_t spilledBytes = 0;
+    int mergePasses = 0;        // times the rows were read back and merged, the last one handing them on
+
+    // e.g. "spilled 1200000 rows, 20.6 MiB, in 12 sorted runs, merged in 1 pass", or empty if nothing spilled
+    std::string describe() const {
+        if (runs == 0)
+            return "";
+        char description[128];
+        std::snprintf(description, sizeof(description), "spilled %zu rows, %.1f MiB, in %zu sorted runs, merged in %d pass%s",
+                      spilledRows, spilledBytes / double(1 << 20), runs, mergePasses, mergePasses == 1 ? "" : "es");
+        return description;
+    }
+};
+
+// a cell written to key, column.bytesNeeded bytes, so that memcmp() orders keys the way the values are ordered, nulls after every value.
+// ints and floats are written big-endian with their bits flipped so unsigned bytes sort them, -0.0 as 0.0,
+// and chars stop at their first '\0', zero padded. descending inverts every byte, which puts nulls first
+void sortKey(const char* cell, const ColumnInfo& column, bool descending, char* key) {
+    std::memset(key, 0, column.bytesNeeded);
+    key[0] = cell[0] ? 1 : 0;
+    if (!cell[0]) {
+        uint32_t bits = 0;
+        if (column.type == int_literal) {
+            std::memcpy(&bits, cell + 1, sizeof(bits));
+            bits ^= 0x80000000u;
+        }
+        else if (column.type == float_literal) {
+            float value;
+            std::memcpy(&value, cell + 1, sizeof(value));
+            value += 0.0f;
+            std::memcpy(&bits, &value, sizeof(bits));
+            bits = bits & 0x80000000u ? ~bits : bits | 0x80000000u;
+        }
+        if (column.type == chars_literal)
+            std::memcpy(key + 1, cell + 1, charsLengthOf(cell + 1, column.charsLength));
+        else
+            for (int byte = 0; byte < 4; ++byte)
+                key[1 + byte] = char(bits >> (24 - 8 * byte));
+    }
+    if (descending)
+        for (int byte = 0; byte < column.bytesNeeded; ++byte)
+            key[byte] = ~key[byte];
+}
+
+// hands sink the rows it's given in order of one of their columns, rows with equal values in the order they came.
+// each row is kept as an entry of its sort key then the row. up to SORT_MEMORY_BUDGET bytes of entries at a time are sorted
+// by their positions and key prefixes, so the entries don't move, and written in that order to a SpillFile as a sorted run.
+// after the last row the runs are merged, up to MAX_MERGE_RUNS at a time, with passes merging runs into longer ones before that
+// when there are more. rows that all fit in the budget are sorted in memory and never spilled.
+// given a layout of the leading columns of the rows it's given, hands on just those
+struct SortSink : ResultSink {
+    ResultSink& sink;
+    std::string columnName;
+    bool descending;
+    const TableInfo* outLayout;     // nullptr to hand on the rows as they came
+    ColumnInfo column{"", int_literal};
+    unsigned int keySize = 0;
+    unsigned int rowSize = 0;
+    unsigned int entrySize = 0;
+    // an entry's position in entries, after the first 8 bytes of its key, big-endian so they compare as the key does
+    struct Position {
+        uint64_t prefix;
+        uint32_t position;
+    };
+
+    std::vector<char> entries;
+    std::vector<Position> order;
+    std::vector<std::unique_ptr<SpillFile>> runs;
+    std::vector<char> out;
+    SortStats stats;
+
+    SortSink(ResultSink& sink, const std::string& columnName, bool descending, const TableInfo* outLayout = nullptr)
+        : sink(sink), columnName(columnName), descending(descending), outLayout(outLayout) {}
+
+    void begin(const std::string& statement, const std::string& tables, const TableInfo& layout) override {
+        column = *std::find_if(layout.columns.begin(), layout.columns.end(), [&](const ColumnInfo& c) { return c.name == columnName; });
+        keySize = column.bytesNeeded;
+        rowSize = layout.rowSize();
+        entrySize = keySize + rowSize;
+        entries.clear();
+        runs.clear();
+        stats = SortStats();
+        out.assign(outLayout ? outLayout->rowSize() : rowSize, '\0');
+        sink.begin(statement, tables, outLayout ? *outLayout : layout);
+    }
+
+    void row(const char* rowBytes) override {
+        size_t end = entries.size();
+        entries.resize(end + entrySize);
+        sortKey(rowBytes + column.offset, column, descending, entries.data() + end);
+        std::memcpy(entries.data() + end + keySize, rowBytes, rowSize);
+        if ((entries.size() / entrySize) * (entrySize + sizeof(Position)) >= SORT_MEMORY_BUDGET)
+            spillRun();
+    }
+
+    void end() override {
+        if (runs.empty()) {
+            sortEntries();
+            for (const Position& p : order)
+                emit(entries.data() + size_t(p.position) * entrySize);
+        }
+        else {
+            if (!entries.empty())
+                spillRun();
+            std::vector<char>().swap(entries);
+            std::vector<Position>().swap(order);
+            mergeRuns();
+        }
+        entries.clear();
+        runs.clear();
+        sink.end();
+    }
+
+    void setFormat(const std::string& format) override {
+        sink.setFormat(format);
+    }
+
+    void emit(const char* entry) {
+        const char* row = entry + keySize;
+        if (!outLayout) {
+            sink.row(row);
+            return;
+        }
+        std::memcpy(out.data(), row, out.size());
+        sink.row(out.data());
+    }
+
+    // order holds the entries' positions, sorted by their keys and then their positions, so equal keys stay in the order they came.
+    // only the prefixes and positions move, and most comparisons end at the prefix without reading the entries
+    void sortEntries() {
+        order.resize(entries.size() / entrySize);
+        for (size_t i = 0; i < order.size(); ++i) {
+            const unsigned char* key = reinterpret_cast<const unsigned char*>(entries.data() + i * entrySize);
+            uint64_t prefix = 0;
+            for (unsigned int byte = 0; byte < 8; ++byte)
+                prefix = prefix << 8 | (byte < keySize ? key[byte] : 0);
+            order[i] = Position{prefix, uint32_t(i)};
+        }
+        const char* first = entries.data();
+        std::sort(order.begin(), order.end(), [&](const Position& a, const Position& b) {
+            if (a.prefix != b.prefix)
+                return a.prefix < b.prefix;
+            if (keySize > 8) {
+                int rest = std::memcmp(first + size_t(a.position) * entrySize + 8, first + size_t(b.position) * entrySize + 8, keySize - 8);
+                if (rest != 0)
+                    return rest < 0;
+            }
+            return a.position < b.position;
+        });
+    }
+
+    void spillRun() {
+        sortEntries();
+        auto run = std::make_unique<SpillFile>(entrySize);
+        for (const Position& p : order)
+            run->write(entries.data() + size_t(p.position) * entrySize);
+        ++stats.runs;
+        stats.spilledRows += order.size();
+        stats.spilledBytes += order.size() * entrySize;
+        runs.push_back(std::move(run));
+        entries.clear();
+    }
+
+    // the rows of every run, in order
+    void mergeRuns() {
+        // as many runs as there's room in the budget for a block of each
+        size_t fanIn = std::clamp<size_t>(SORT_MEMORY_BUDGET / (BATCH_SIZE * size_t(entrySize)), 2, MAX_MERGE_RUNS);
+        while (runs.size() > fanIn) {
+            std::vector<std::unique_ptr<SpillFile>> merged;
+            for (size_t first = 0; first < runs.size(); first += fanIn) {
+                size_t last = std::min(runs.size(), first + fanIn);
+                auto run = std::make_unique<SpillFile>(entrySize);
+                merge(first, last, [&](const char* entry) { run->write(entry); });
+                for (size_t i = first; i < last; ++i)
+                    runs[i].reset();
+                merged.push_back(std::move(run));
+            }
+            runs = std::move(merged);
+            ++stats.mergePasses;
+        }
+        merge(0, runs.size(), [&](const char* entry) { emit(entry); });
+        ++stats.mergePasses;
+    }
+
+    // runs first to last merged into one order, each entry passed to next. equal keys come from the earlier run first, so rows stay in the order they came
+    template <typename Next>
+    void merge(size_t first, size_t last, Next next) {
+        struct Reader {
+            SpillFile* run;
+            std::vector<char> block;
+            size_t count = 0;
+            size_t at = 0;
+
+            bool advance() {
+                if (++at < count)
+                    return true;
+                count = run->readBlock(block.data(), BATCH_SIZE);
+                at = 0;
+                return count != 0;
+            }
+
+            const char* entry() const {
+                return block.data() + at * run->rowSize;
+            }
+        };
+
+        std::vector<Reader> readers;
+        for (size_t i = first; i < last; ++i) {
+            runs[i]->reset();
+            readers.push_back(Reader{runs[i].get(), std::vector<char>(BATCH_SIZE * size_t(entrySize))});
+        }
+        auto later = [&](size_t a, size_t b) {
+            int order = std::memcmp(readers[a].entry(), readers[b].entry(), keySize);
+            return order > 0 || (order == 0 && a > b);
+        };
+        std::priority_queue<size_t, std::vector<size_t>, decltype(later)> heads(later);
+        for (size_t i = 0; i < readers.size(); ++i) {
+            readers[i].at = BATCH_SIZE;
+            if (readers[i].advance())
+                heads.push(i);
+        }
+        while (!heads.empty()) {
+            size_t i = heads.top();
+            heads.pop();
+            next(readers[i].entry());
+            if (readers[i].advance())
+                heads.push(i);
+        }
+    }
+};
+
+#endif
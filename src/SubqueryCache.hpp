@@ -0,0 +1,123 @@
+// SubqueryCache.hpp
+
+#ifndef SUBQUERYCACHE
+#define SUBQUERYCACHE
+
+#include <map>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <filesystem>
+#include "TableInfo.hpp"
+#include "Table.hpp"
+#include "ColumnSummary.hpp"
+
+// the rhs column of an in, any, or all, read once into summaries of its values
+struct ColumnSet {
+    element_type type;
+    ColumnSummary<int> ints;
+    ColumnSummary<float> floats;
+    ColumnSummary<std::string> chars;
+    ColumnSummary<bool> bools;
+
+    ColumnSet(TableInfo t, const std::string& columnName) : type(t[columnName]->type) {
+        Table table(t);
+        table.reset();
+        while (table.nextRow()) {
+            bool isNull = table.isNull(columnName);
+            switch (type) {
+                case int_literal:
+                    isNull ? ints.addNull() : ints.add(table.getInt(columnName));
+                    break;
+                case float_literal:
+                    isNull ? floats.addNull() : floats.add(table.getFloat(columnName));
+                    break;
+                case chars_literal:
+                    isNull ? chars.addNull() : chars.add(table.getChars(columnName));
+                    break;
+                case bool_literal:
+                    isNull ? bools.addNull() : bools.add(table.getBool(columnName));
+                    break;
+            }
+        }
+        ints.finish();
+        floats.finish();
+        chars.finish();
+        bools.finish();
+    }
+};
+
+// column sets shared by every in, any, and all that reads the same table column, in one statement or across statements,
+// so each is read from disk once until its table is written to
+//
+// entries are keyed by table file and column. each table file has a version, bumped by tableWritten() on every insert, update,
+// delete, define, and drop, and an entry is only used while its table is at the version it was read at.
+// the file's size and modification time are checked too, in case it was written some other way
+struct SubqueryCache {
+    static const size_t MAX_ENTRIES = 64;   // past this, the least recently used entry is dropped
+
+    struct Entry {
+        unsigned long version;
+        std::uintmax_t fileSize;
+        std::filesystem::file_time_type modified;
+        std::shared_ptr<const ColumnSet> set;
+        unsigned long lastUsed;
+    };
+
+    std::map<std::string, unsigned long> versions;                     // by table file
+    std::map<std::pair<std::string, std::string>, Entry> entries;      // by table file and column
+    unsigned long uses = 0;
+    size_t reads = 0;       // column sets read from disk
+    size_t hits = 0;        // column sets found here instead
+    std::mutex mutex;
+
+    static std::string fileOf(const std::string& tableName) {
+        return TABLE_DIRECTORY + tableName + FILE_EXTENSION;
+    }
+
+    // the column set of t.columnName as the table is now
+    std::shared_ptr<const ColumnSet> get(const TableInfo& t, const std::string& columnName) {
+        std::string file = fileOf(t.name);
+        std::uintmax_t fileSize = std::filesystem::file_size(file);
+        std::filesystem::file_time_type modified = std::filesystem::last_write_time(file);
+        unsigned long version;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            version = versions[file];
+            auto found = entries.find({file, columnName});
+            if (found != entries.end() && found->second.version == version && found->second.fileSize == fileSize && found->second.modified == modified) {
+                ++hits;
+                found->second.lastUsed = ++uses;
+                return found->second.set;
+            }
+        }
+
+        // read without holding the lock. a write that lands meanwhile bumps the version past the one this is stored under
+        auto set = std::make_shared<const ColumnSet>(t, columnName);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        ++reads;
+        if (entries.size() >= MAX_ENTRIES && !entries.count({file, columnName})) {
+            auto oldest = entries.begin();
+            for (auto it = entries.begin(); it != entries.end(); ++it)
+                if (it->second.lastUsed < oldest->second.lastUsed)
+                    oldest = it;
+            entries.erase(oldest);
+        }
+        entries[{file, columnName}] = Entry{version, fileSize, modified, set, ++uses};
+        return set;
+    }
+
+    // tableName in TABLE_DIRECTORY was written to, so its column sets are out of date
+    void tableWritten(const std::string& tableName) {
+        std::string file = fileOf(tableName);
+        std::lock_guard<std::mutex> lock(mutex);
+        ++versions[file];
+        for (auto it = entries.begin(); it != entries.end();)
+            it = it->first.first == file ? entries.erase(it) : std::next(it);
+    }
+};
+
+SubqueryCache SUBQUERY_CACHE;
+
+#endif
@@ -10,6 +10,37 @@
 std::string TABLE_DIRECTORY = "../tables/";
 std::string FILE_EXTENSION = ".ftbl";
 
+// get a cell as a string, given a pointer to its null byte
+std::string cellToString(const char* cell, const ColumnInfo& c) {
+
+    if (*(uint8_t*)cell)
+        return "$null";
+
+    switch (c.type) {
+
+        case int_literal:
+            return std::to_string(*(int*)(cell + 1));
+
+        case float_literal:
+            return std::to_string(*(float*)(cell + 1));
+
+        case chars_literal: {
+            std::string str(cell + 1, c.charsLength);
+            str.erase(std::find(str.begin(), str.end(), '\0'), str.end()); // Remove all null characters
+            return str;
+        }
+
+        case bool_literal:
+            if (*(uint8_t*)(cell + 1) == 0)
+                return "false";
+            else
+                return "true";
+
+        default:
+            throw QueryError() << "Bad column type in cellToString().\n";
+    }
+}
+
 struct Table {
     
     TableInfo t;
@@ -17,6 +48,8 @@ struct Table {
     char* currentRow;
     unsigned int rowSize;
     unsigned int dataStartPosition;
+    std::streampos blockStart = 0;  // where the last block read by readBlock() starts and ends
+    std::streampos blockEnd = 0;
 
     // constructor
     Table(TableInfo& t) : t(t) {
@@ -75,31 +108,7 @@ struct Table {
     // get value as a string
     std::string getValueString(const std::string& columnName) {
         ColumnInfo* c = t[columnName];
-
-        if (isNull(columnName))
-            return "$null";
-
-        switch (c->type) {
-
-            case int_literal:
-                return std::to_string(getInt(columnName));
-
-            case float_literal:
-                return std::to_string(getFloat(columnName));
-
-            case chars_literal:
-                return getChars(columnName);
-
-            case bool_literal:
-                if (getBool(columnName) == 0)
-                    return "false";
-                else
-                    return "true";
-
-            default:
-                std::cout << "Bad column type in Table::getValueString().\n";
-                exit(1);
-        }
+        return cellToString(currentRow + c->offset, *c);
     }
 
     // write an int
@@ -136,7 +145,7 @@ struct Table {
         file.write(&nullByte, 1);
         file.write(value.c_str(), value.length());
         // pad rest with nulls
-        for (int i = 0; i < c->bytesNeeded-value.length(); ++i) 
+        for (int i = 0; i < c->charsLength-value.length(); ++i) 
             file.write(&nullByte, 1);
 
         file.seekg(current);
@@ -237,8 +246,7 @@ struct Table {
             }
 
             default:
-                std::cerr << "Error in Table::compareCell(), likely during a join. Somehow, column \"" << columnName << "\" in table \"" << t.name << "\" is not one of the literal types.\n";
-                exit(1);
+                throw QueryError() << "Error in Table::compareCell(), likely during a join. Somehow, column \"" << columnName << "\" in table \"" << t.name << "\" is not one of the literal types.\n";
         }
 
         // default return to silence warnings. this code should never execute
@@ -271,8 +279,7 @@ struct Table {
                     break;
                 
                 default:
-                    std::cout << "Error in Table::compareRow(), likely during an intersect. Somehow, column \"" << column.name << "\" in table \"" << t.name << "\" is not one of the literal types.\n";
-                    exit(1);
+                    throw QueryError() << "Error in Table::compareRow(), likely during an intersect. Somehow, column \"" << column.name << "\" in table \"" << t.name << "\" is not one of the literal types.\n";
             }
         }
         return true;
@@ -308,6 +315,25 @@ struct Table {
     // return to before first item
     void reset() {
         file.seekg(dataStartPosition, std::ios_base::beg);
+        blockEnd = dataStartPosition;
+    }
+
+    // read up to maxRows rows into buffer, rowSize bytes apart, deleted rows included. returns the number read, 0 at the end
+    // the setters and markForDeletion() go back to writing the current row only after seekToBlockRow()
+    size_t readBlock(char* buffer, size_t maxRows) {
+        blockStart = blockEnd;
+        file.seekg(blockStart, std::ios_base::beg);
+        file.read(buffer, maxRows * rowSize);
+        size_t rowsRead = file.gcount() / rowSize;
+        file.clear();
+        blockEnd = blockStart + std::streamoff(rowsRead * rowSize);
+        file.seekg(blockEnd, std::ios_base::beg);
+        return rowsRead;
+    }
+
+    // make row i of the last block read the one the setters and markForDeletion() write to
+    void seekToBlockRow(size_t i) {
+        file.seekg(blockStart + std::streamoff((i + 1) * rowSize), std::ios_base::beg);
     }
 
     // advance to next non-deleted row
@@ -8,9 +8,14 @@
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <map>
+#include <set>
 #include <memory>
 #include <optional>
+#include <algorithm>
+#include <filesystem>
 #include "node.hpp"
+#include "QueryError.hpp"
 
 // data about a column
 struct ColumnInfo {
@@ -70,6 +75,18 @@ struct ColumnInfo {
 // forward declaration needed for table
 element_type byteToColumnType(char signedByte);
 
+// number of bytes a column takes up in a row, including its null byte
+int bytesNeededFor(element_type columnType, int charsLength) {
+    switch (columnType) {
+        case int_literal: return 5;
+        case float_literal: return 5;
+        case chars_literal: return 1 + charsLength;
+        case bool_literal: return 2;
+        default:
+            throw QueryError() << "Error laying out a row. Somehow, a column is not one of the literal types.\n";
+    }
+}
+
 // data about a table
 struct TableInfo {
     std::string name;
@@ -78,7 +95,28 @@ struct TableInfo {
 
     TableInfo() : name(""), columns({}) {};
 
-    TableInfo(std::string tableName, std::vector<ColumnInfo> tableColumns) : name(tableName), columns(tableColumns) {};
+    // lays the columns out in the order given, the same way they would be in a file
+    TableInfo(std::string tableName, std::vector<ColumnInfo> tableColumns) : name(tableName), columns(tableColumns) {
+        int offset = 1;
+        for (ColumnInfo& c : columns) {
+            c.bytesNeeded = bytesNeededFor(c.type, c.charsLength);
+            c.offset = offset;
+            offset += c.bytesNeeded;
+        }
+        mapColumns();
+    };
+
+    // nameToColumnInfo points into columns, so copies must rebuild it
+    TableInfo(const TableInfo& other) : name(other.name), columns(other.columns) {
+        mapColumns();
+    }
+
+    TableInfo& operator=(const TableInfo& other) {
+        name = other.name;
+        columns = other.columns;
+        mapColumns();
+        return *this;
+    }
 
     TableInfo(const std::string& filePath) {
         // access the file
@@ -125,9 +163,8 @@ struct TableInfo {
             else if (columnType == chars_literal) bytesNeeded = 1 + numChars;
             else if (columnType == bool_literal) bytesNeeded = 2;
             else {
-                std::cout << "Error constructing columnInfo for \"" << std::string(columnNameBuffer)
-                          << "\". Somehow, a column is not one of the literal types.\n";
-                exit(1);
+                throw QueryError() << "Error constructing columnInfo for \"" << std::string(columnNameBuffer)
+                                   << "\". Somehow, a column is not one of the literal types.\n";
             }
 
             columns.push_back(ColumnInfo(std::string(columnNameBuffer), columnType, numChars, bytesNeeded, offset));
@@ -135,6 +172,11 @@ struct TableInfo {
             currentPos += 68;
         }
 
+        mapColumns();
+    }
+
+    void mapColumns() {
+        nameToColumnInfo.clear();
         for (ColumnInfo& c : columns) {
             nameToColumnInfo.insert({c.name, &c});
         }
@@ -143,6 +185,14 @@ struct TableInfo {
     ColumnInfo* operator[](const std::string& columnName) {
         return nameToColumnInfo[columnName];
     }
+
+    // size of one row, including the delete byte
+    int rowSize() const {
+        int size = 1;
+        for (const ColumnInfo& c : columns)
+            size += c.bytesNeeded;
+        return size;
+    }
 };
 
 // identifier has '.'
@@ -169,8 +219,7 @@ std::pair<std::string, std::string> split(const std::string& name) {
 TableInfo nodeToTableInfo(const std::shared_ptr<node>& n) {
     // node must be a definition
     if (n->type != definition) {
-        std::cout << "Error converting node to table: Node is not a definition!\n";
-        exit(1);        
+        throw QueryError() << "Error converting node to table: Node is not a definition!\n";
     }
 
     std::vector<ColumnInfo> cols;
@@ -194,8 +243,7 @@ TableInfo nodeToTableInfo(const std::shared_ptr<node>& n) {
                 colType = bool_literal;
                 break;
             default:
-                std::cout << "Error in nodeToTable(). Somehow, an unknown column type was provided.\n";
-                exit(1);
+                throw QueryError() << "Error in nodeToTable(). Somehow, an unknown column type was provided.\n";
         }
         
         // if the type is chars, then we need know how many
@@ -234,6 +282,22 @@ std::vector<TableInfo>::const_iterator find(const std::string& tableName, const
     return it;
 }
 
+// which joined table each column of a join's result is in, and its index in that table, by its name after aliasing.
+// tableColumns is how many columns each joined table has, in the order the join names them. a name more than one table has,
+// as every column of a table joined with itself does, can't tell which is meant, so it's left out
+std::map<std::string, std::pair<size_t, size_t>> joinedColumnTables(const std::vector<ColumnInfo>& joinedColumns, const std::vector<size_t>& tableColumns) {
+    std::map<std::string, std::pair<size_t, size_t>> tableOf;
+    std::set<std::string> ambiguous;
+    size_t column = 0;
+    for (size_t t = 0; t < tableColumns.size(); ++t)
+        for (size_t c = 0; c < tableColumns[t]; ++c, ++column)
+            if (!tableOf.insert({joinedColumns[column].name, {t, c}}).second)
+                ambiguous.insert(joinedColumns[column].name);
+    for (auto& name : ambiguous)
+        tableOf.erase(name);
+    return tableOf;
+}
+
 // column exists in a vector of columns
 bool exists(const std::string& columnName, const std::vector<ColumnInfo>& columns) {
     return std::find_if(columns.begin(), columns.end(), [&columnName](const auto& c){return c.name == columnName;}) != columns.end();
@@ -253,8 +317,7 @@ element_type byteToColumnType(char signedByte) {
     typeMap[0b00000011] = chars_literal;
 
     if (typeMap.find(byte) == typeMap.end()) {
-        std::cout << "Error while reading a table. Could not recognize column type: \"" << byte << "\"\n";
-        exit(1);
+        throw QueryError() << "Error while reading a table. Could not recognize column type: \"" << byte << "\"\n";
     }
 
     return typeMap[byte];
@@ -269,8 +332,7 @@ unsigned char columnTypeToByte(element_type columnType) {
     typeMap[chars_literal] = 0b00000011;
 
     if (typeMap.find(columnType) == typeMap.end()) {
-        std::cout << "Error while reading a table. Unknown datatype: \"" << columnType << "\"\n";
-        exit(1);
+        throw QueryError() << "Error while reading a table. Unknown datatype: \"" << columnType << "\"\n";
     }
 
     return typeMap[columnType];
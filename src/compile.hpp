@@ -0,0 +1,167 @@
+// compile.hpp
+
+#ifndef COMPILE
+#define COMPILE
+
+#include <functional>
+#include "node.hpp"
+#include "TableInfo.hpp"
+#include "PredicateProgram.hpp"
+#include "Parameters.hpp"
+#include "simplify.hpp"
+
+// the term for a where clause on table t, adding each comparison in it to program.leaves
+// parameters gets a binder for every ?N in the expression, which writes the bound value into its comparison
+Term compileTerm(std::shared_ptr<node> boolExprRoot, const TableInfo& t, PredicateProgram& program, Parameters& parameters) {
+
+    // (bool_expr)
+    if (boolExprRoot->components.size() == 1)
+        return compileTerm(boolExprRoot->components[0], t, program, parameters);
+
+    // !(bool_expr)
+    else if (boolExprRoot->components[0]->type == op_not) {
+        Term term;
+        term.kind = Term::Not;
+        term.children.push_back(compileTerm(boolExprRoot->components[1], t, program, parameters));
+        return term;
+    }
+
+    // bool_expr op_or bool_expr, bool_expr op_and bool_expr. a chain of the same operator becomes one group
+    else if (boolExprRoot->components[1]->type == op_or || boolExprRoot->components[1]->type == op_and) {
+        Term term;
+        term.kind = boolExprRoot->components[1]->type == op_or ? Term::Or : Term::And;
+        for (int side : {0, 2}) {
+            Term child = compileTerm(boolExprRoot->components[side], t, program, parameters);
+            if (child.kind == term.kind)
+                std::move(child.children.begin(), child.children.end(), std::back_inserter(term.children));
+            else
+                term.children.push_back(std::move(child));
+        }
+        return term;
+    }
+
+    auto lhsColumn = find(boolExprRoot->components[0]->value, t.columns);
+    const Opcode literalCodes[] = {INT_LITERAL, FLOAT_LITERAL, BOOL_LITERAL, CHARS_LITERAL};
+    const Opcode columnCodes[] = {INT_COLUMN, FLOAT_COLUMN, BOOL_COLUMN, CHARS_COLUMN};
+    const Opcode anyCodes[] = {INT_ANY, FLOAT_ANY, BOOL_ANY, CHARS_ANY};
+    const Opcode allCodes[] = {INT_ALL, FLOAT_ALL, BOOL_ALL, CHARS_ALL};
+    int type = columnTypeToByte(lhsColumn->type);
+
+    Instruction instruction(literalCodes[type]);
+    instruction.lhs = lhsColumn->offset;
+    instruction.lhsLength = lhsColumn->charsLength;
+    std::string text = lhsColumn->name + ' ';
+
+    Term term;
+    term.leaf = program.leaves.size();
+
+    // identifier in identifier, identifier comparison any/all identifier
+    if (boolExprRoot->components[1]->type == kw_in || boolExprRoot->components[2]->type == kw_any || boolExprRoot->components[2]->type == kw_all) {
+        bool isIn = boolExprRoot->components[1]->type == kw_in;
+        auto rhsIdentifier = split(boolExprRoot->components[isIn ? 2 : 3]->value);
+        TableInfo rhsTable(TABLE_DIRECTORY + rhsIdentifier.first + FILE_EXTENSION);
+        auto rhsColumn = find(rhsIdentifier.second, rhsTable.columns);
+
+        instruction.code = boolExprRoot->components[2]->type == kw_all ? allCodes[type] : anyCodes[type];
+        instruction.op = isIn ? op_equals : boolExprRoot->components[1]->type;
+        instruction.index = program.subqueries.size();
+        program.subqueries.push_back(std::make_unique<Subquery>(rhsTable, rhsColumn->name));
+
+        if (isIn)
+            text += "in ";
+        else
+            text += tokenTypeToString(instruction.op) + ' ' + tokenTypeToString(boolExprRoot->components[2]->type) + ' ';
+        text += boolExprRoot->components[isIn ? 2 : 3]->value;
+
+        program.leaves.push_back(instruction);
+        program.leafText.push_back(text);
+        return term;
+    }
+
+    instruction.op = boolExprRoot->components[1]->type;
+    text += tokenTypeToString(instruction.op) + ' ';
+    std::shared_ptr<node> rhs = boolExprRoot->components[2];
+    switch (rhs->type) {
+        case identifier: {
+            auto rhsColumn = find(rhs->value, t.columns);
+            instruction.code = columnCodes[type];
+            instruction.rhs = rhsColumn->offset;
+            instruction.rhsLength = rhsColumn->charsLength;
+            text += rhsColumn->name;
+            break;
+        }
+        case int_literal:
+            instruction.intValue = stoi(rhs->value);
+            text += rhs->value;
+            break;
+        case float_literal:
+            instruction.floatValue = stof(rhs->value);
+            text += rhs->value;
+            break;
+        case chars_literal:
+            instruction.index = program.strings.size();
+            program.strings.push_back(rhs->value);
+            text += '"' + rhs->value + '"';
+            break;
+        case bool_literal:
+            instruction.boolValue = rhs->value == "true";
+            text += rhs->value;
+            break;
+        case kw_null:
+            instruction.code = instruction.op == op_equals ? IS_NULL : IS_NOT_NULL;
+            text += "null";
+            break;
+
+        case parameter:
+            if (lhsColumn->type == chars_literal) {
+                instruction.index = program.strings.size();
+                program.strings.push_back("");
+            }
+            text += '?' + rhs->value;
+            break;
+    }
+
+    program.leaves.push_back(instruction);
+    program.leafText.push_back(text);
+
+    // the literal is filled in by a binder whenever a value is bound, in leaves and, once it's been emitted, in code
+    if (rhs->type == parameter) {
+        int leaf = term.leaf;
+        PredicateProgram* p = &program;
+        parameters.addBinder(stoi(rhs->value), [p, leaf](const std::string& value) {
+            std::vector<Instruction*> copies = {&p->leaves[leaf]};
+            if (leaf < p->leafPosition.size())
+                copies.push_back(&p->code[p->leafPosition[leaf]]);
+            for (Instruction* i : copies) {
+                switch (i->code) {
+                    case INT_LITERAL: i->intValue = stoi(value); break;
+                    case FLOAT_LITERAL: i->floatValue = stof(value); break;
+                    case CHARS_LITERAL: p->strings[i->index] = value; break;
+                    case BOOL_LITERAL: i->boolValue = value == "true"; break;
+                }
+            }
+        });
+    }
+    return term;
+}
+
+// compile a where clause on table t into program, after simplify()ing it
+// one that's true for every row leaves program empty, and one that's false for every row sets program.alwaysFalse
+void compileProgram(std::shared_ptr<node> boolExprRoot, const TableInfo& t, PredicateProgram& program, Parameters& parameters) {
+    boolExprRoot = simplify(boolExprRoot, t);
+    if (boolExprRoot->type == kw_true)
+        return;
+    if (boolExprRoot->type == kw_false) {
+        program.alwaysFalse = true;
+        return;
+    }
+
+    program.root = compileTerm(boolExprRoot, t, program, parameters);
+    std::function<bool(const Term&)> hasGroup = [&](const Term& term) {
+        return term.kind == Term::And || term.kind == Term::Or || (term.kind == Term::Not && hasGroup(term.children[0]));
+    };
+    program.adaptive = hasGroup(program.root);
+    program.emit();
+}
+
+#endif
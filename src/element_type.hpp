@@ -37,6 +37,8 @@ enum element_type {
 
     drop = -1,
 
+    output = 17,
+
     // terminals - tokens and leaf nodes
     // keywords
     kw_select = 20,
@@ -72,6 +74,8 @@ enum element_type {
     kw_chars = 44,
 
     kw_drop = 45,
+
+    kw_output = 46,
     
     // identifiers and literals
     identifier = 50,        // column name, table name, alias       
@@ -82,6 +86,7 @@ enum element_type {
     kw_true = 55,
     kw_false = 56,          // nodes with type kw_true or kw_false will have value type bool_literal, but value "true" and "false" respectively
     bool_literal = 57,      // should only be used column type checking
+    parameter = 58,         // ?1, ?2, ... placeholder in a prepared statement, value holds the number
 
     // punctuation 
     colon = 70,          
@@ -136,6 +141,7 @@ std::string tokenTypeToString(element_type type) {
         case col_type: return "column, type pair";
 
         case drop: return "drop statement";
+        case output: return "output statement";
 
         case kw_select: return "select";
         case kw_from: return "from";
@@ -168,6 +174,7 @@ std::string tokenTypeToString(element_type type) {
         case kw_chars: return "keyword chars";
 
         case kw_drop: return "drop";
+        case kw_output: return "output";
 
         case identifier: return "identifier";
         case int_literal: return "int";
@@ -177,6 +184,7 @@ std::string tokenTypeToString(element_type type) {
         case kw_false: return "false";
         case kw_null: return "null";
         case bool_literal: return "bool";
+        case parameter: return "parameter";
 
         case colon: return "colon";
         case open_parenthesis: return "open parenthesis";
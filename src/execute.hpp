@@ -9,34 +9,25 @@
 #include <algorithm>
 #include <string>
 #include <map>
+#include <unordered_set>
+#include <unordered_map>
+#include <string_view>
+#include <cstring>
 #include "TableInfo.hpp"
 #include "node.hpp"
 #include "Table.hpp"
-#include "convert.hpp"
-
-#define UNDERLINE "\033[4m"
-#define CLOSEUNDERLINE "\033[0m"
-
-// join
-void executeJoin(std::shared_ptr<node> joinRoot) {
-    std::string table1Name = joinRoot->components[0]->value;
-    std::string table2Name = joinRoot->components[1]->value;
-    TableInfo t1(TABLE_DIRECTORY + table1Name + FILE_EXTENSION);
-    TableInfo t2(TABLE_DIRECTORY + table2Name + FILE_EXTENSION);
-
-    auto onRoot = joinRoot->components[2];
-    auto aliasListRoot = joinRoot->components[3];
-    auto joinedColumn1Name = split(onRoot->components[0]->value);
-    auto joinedColumn2Name = split(onRoot->components[2]->value);
-    element_type operation = onRoot->components[1]->type;
-
-    Table table1(t1);
-    Table table2(t2);
-
-    // output statment
-    std::cout << "\n\033[0;34m$ join\033[0m " << "\033[0;32m" << table1Name << ", " << table2Name << "\033[0m" << '\n';
-
-    // output column names
+#include "compile.hpp"
+#include "Parameters.hpp"
+#include "ResultSink.hpp"
+#include "Distinct.hpp"
+#include "Sort.hpp"
+#include "SubqueryCache.hpp"
+#include "Join.hpp"
+#include "Batch.hpp"
+#include "QueryError.hpp"
+
+// the columns of a join's result: every column of each joined table, in the order the join names them, aliased where the alias list says so
+std::vector<ColumnInfo> joinColumns(const std::vector<TableInfo>& joinedTables, std::shared_ptr<node> aliasListRoot) {
     std::vector<ColumnInfo> columns;
     // same as validation to find column names
     // build map from table.column name to alias
@@ -44,7 +35,8 @@ void executeJoin(std::shared_ptr<node> joinRoot) {
     for (auto& aliasRoot : aliasListRoot->components)
         nameToAlias.insert({aliasRoot->components[0]->value, aliasRoot->components[1]->value});
     // go through columns of each table
-    for (const auto& t : {&t1, &t2}) {
+    for (const TableInfo& table : joinedTables) {
+        const TableInfo* t = &table;
         for (const ColumnInfo& c : t->columns) {
             std::string aliasName;                
             // no alias, add original name
@@ -55,214 +47,794 @@ void executeJoin(std::shared_ptr<node> joinRoot) {
                 columns.push_back(ColumnInfo(aliasName, c.type, c.charsLength));
         }
     }
-    
-    std::cout << UNDERLINE;
-    for (auto& column : columns) {
-        std::cout << std::right << std::setw(column.outputWidth) << column.name << ' ';
-    }
-    std::cout << '\n' << CLOSEUNDERLINE;
+    return columns;
+}
 
-    // output the join
-    while (table1.nextRow()) {
-        while (table2.nextRow()) {
-            // match not found, skip
-            if (!table1.compareCell(joinedColumn1Name.second, operation, table2, joinedColumn2Name.second))
-                continue;
+// an on expr with its columns found in the joined tables, the same way validation finds them
+JoinCondition joinCondition(std::shared_ptr<node> onRoot, const std::vector<std::string>& tableNames, std::vector<TableInfo>& joinedTables) {
+    auto column1Name = split(onRoot->components[0]->value);
+    auto column2Name = split(onRoot->components[2]->value);
+    size_t table1 = std::find(tableNames.begin(), tableNames.end(), column1Name.first) - tableNames.begin();
+    size_t table2 = std::find(tableNames.begin(), tableNames.end(), column2Name.first) - tableNames.begin();
+    // a table joined with itself
+    if (table1 == table2)
+        table2 = 1;
+    return JoinCondition{table1, joinedTables[table1][column1Name.second], onRoot->components[1]->type, table2, joinedTables[table2][column2Name.second]};
+}
 
-            // match found, output row
-            for (const ColumnInfo column : t1.columns)
-                std::cout << std::right << std::setw(column.outputWidth) << table1.getValueString(column.name) << ' ';
-            for (const ColumnInfo column : t2.columns)
-                std::cout << std::right << std::setw(column.outputWidth) << table2.getValueString(column.name) << ' ';
-            
-            // dont break, continue looking for matches
-            std::cout << '\n';
-        }
-        // reached the end of table 2, reset
-        table2.reset();
+// the columns a join's column list selects, as each one's table and its index in that table, in the order the list names them.
+// a table joined with itself: a column named a second time is in the second copy. without a column list, every column in order
+std::vector<std::pair<size_t, size_t>> joinSelection(std::shared_ptr<node> columnListRoot, const std::vector<std::string>& tableNames, std::vector<TableInfo>& joinedTables) {
+    std::vector<std::pair<size_t, size_t>> selected;
+    if (columnListRoot->type == nullnode || columnListRoot->components[0]->type == asterisk) {
+        for (size_t i = 0; i < joinedTables.size(); ++i)
+            for (size_t c = 0; c < joinedTables[i].columns.size(); ++c)
+                selected.push_back({i, c});
+        return selected;
+    }
+    for (auto& columnRoot : columnListRoot->components) {
+        auto columnName = split(columnRoot->value);
+        size_t table = std::find(tableNames.begin(), tableNames.end(), columnName.first) - tableNames.begin();
+        size_t column = joinedTables[table][columnName.second] - joinedTables[table].columns.data();
+        if (std::find(selected.begin(), selected.end(), std::make_pair(table, column)) != selected.end())
+            table = 1;
+        selected.push_back({table, column});
     }
+    return selected;
 }
 
-// mark a row for deletion
-void executeDeletion(std::shared_ptr<node> deletionRoot) {
-    std::string tableName = deletionRoot->components[0]->value;
-    TableInfo t(TABLE_DIRECTORY + tableName + FILE_EXTENSION);
-    auto boolExprRoot = deletionRoot->components[1]->components[0];
+// copy the named columns of source, a row laid out by sourceLayout, into a row laid out by layout, padding shorter chars columns with nulls
+void copyColumns(const char* source, TableInfo& sourceLayout, const TableInfo& layout, std::vector<char>& row) {
+    for (const ColumnInfo& column : layout.columns) {
+        const ColumnInfo* sourceColumn = sourceLayout[column.name];
+        const char* columnBytes = source + sourceColumn->offset;
+        std::copy(columnBytes, columnBytes + sourceColumn->bytesNeeded, row.begin() + column.offset);
+        std::fill(row.begin() + column.offset + sourceColumn->bytesNeeded, row.begin() + column.offset + column.bytesNeeded, '\0');
+    }
+}
 
-    Table table(t);
-    std::shared_ptr<EvaluationNode> EvaluationRoot = convert(boolExprRoot, table, t);
-    while (table.nextRow()) {
-        if (!EvaluationRoot->evaluate())
+// copy the named columns of a table's current row
+void copyColumns(Table& table, const TableInfo& layout, std::vector<char>& row) {
+    copyColumns(table.currentRow, table.t, layout, row);
+}
+
+// a row's cells, sourceColumns in the order of layout's columns, in a form two rows that intersect counts as equal have the same bytes of,
+// written to row without a delete byte. the same as Table::compareRow() compares: null bytes are left out and a null cell's value is zeros,
+// as an inserted one is, -0.0 is 0.0, and chars stop at their first '\0', padded to layout's length. false if a cell is NaN, which equals nothing
+bool canonicalRow(const char* source, const std::vector<const ColumnInfo*>& sourceColumns, const TableInfo& layout, char* row) {
+    for (size_t c = 0; c < sourceColumns.size(); ++c) {
+        const ColumnInfo& column = layout.columns[c];
+        const char* cell = source + sourceColumns[c]->offset;
+        char* canonical = row + column.offset - 1;
+        std::memset(canonical, 0, column.bytesNeeded);
+        if (cell[0])
             continue;
-        table.markForDeletion();
+        if (column.type == float_literal) {
+            float value;
+            std::memcpy(&value, cell + 1, sizeof(float));
+            if (value != value)
+                return false;
+            value += 0.0f;
+            std::memcpy(canonical + 1, &value, sizeof(float));
+        }
+        else if (column.type == chars_literal)
+            std::memcpy(canonical + 1, cell + 1, charsLengthOf(cell + 1, sourceColumns[c]->charsLength));
+        else
+            std::memcpy(canonical + 1, cell + 1, sourceColumns[c]->bytesNeeded - 1);
     }
+    return true;
 }
 
+// the canonical rows of the table an intersect hashes, each with whether a row of the other table equals it
+// past BLOOM_MIN_ROWS rows, the same point ColumnSummary puts one in front of a set, a BloomFilter rules out most rows that aren't here
+struct IntersectKeys {
+    static const size_t BLOOM_MIN_ROWS = 16384;
+
+    unsigned int keySize;
+    std::vector<char> keys;     // in the order they were added, keySize bytes apart
+    std::unordered_map<std::string_view, bool> matched;
+    BloomFilter bloom;
+
+    IntersectKeys(unsigned int keySize) : keySize(keySize) {}
+
+    size_t size() const {
+        return keys.size() / keySize;
+    }
+
+    void add(const char* key) {
+        keys.insert(keys.end(), key, key + keySize);
+    }
+
+    // after the last add()
+    void finish() {
+        matched.reserve(size());
+        for (size_t offset = 0; offset < keys.size(); offset += keySize)
+            matched.insert({std::string_view(keys.data() + offset, keySize), false});
+        if (size() < BLOOM_MIN_ROWS)
+            return;
+        bloom.reserve(size());
+        for (auto& entry : matched)
+            bloom.add(BloomFilter::mix(std::hash<std::string_view>()(entry.first)));
+    }
+
+    // whether a row equal to key has been matched, nullptr if there's no row equal to key
+    bool* find(const char* key) {
+        std::string_view k(key, keySize);
+        if (bloom.enabled() && !bloom.mayContain(BloomFilter::mix(std::hash<std::string_view>()(k))))
+            return nullptr;
+        auto found = matched.find(k);
+        return found == matched.end() ? nullptr : &found->second;
+    }
+};
+
 // execute bag union/intersect
-void executeBagOp(std::shared_ptr<node> selectionRoot) {
-    std::string table1Name = selectionRoot->components[1]->value;
-    std::string table2Name = selectionRoot->components[2]->value;
+void executeBagOp(std::shared_ptr<node> bagOpRoot, ResultSink& sink) {
+    std::string table1Name = bagOpRoot->components[1]->value;
+    std::string table2Name = bagOpRoot->components[2]->value;
     TableInfo t1(TABLE_DIRECTORY + table1Name + FILE_EXTENSION);
     TableInfo t2(TABLE_DIRECTORY + table2Name + FILE_EXTENSION);
-    element_type bagOpType = selectionRoot->components[0]->type;
-
-    // statement output
-    std::cout << "\n\033[0;34m$ bag " << (bagOpType == kw_union ? "union\033[0m " : "intersect\033[0m ") << "\033[0;32m" << table1Name << ", " << table2Name << "\033[0m" << '\n';
+    element_type bagOpType = bagOpRoot->components[0]->type;
 
     Table table1(t1);
     Table table2(t2);
 
-    // get a vector of pointers to ColumnInfos with the larger widths
-    std::vector<const ColumnInfo*> largerColumns;
-    for (const ColumnInfo& column : t1.columns)
-        largerColumns.push_back(column.outputWidth > t2[column.name]->outputWidth ? &column : t2[column.name]);
+    std::vector<ColumnInfo> columns = t1.columns;
+    // for each chars column, make sure that the larger one is put into columns
+    for (auto& column : columns) {
+        const ColumnInfo* c2 = t2[column.name];
+        if (column.type == chars_literal)
+            column.charsLength = std::max(column.charsLength, c2->charsLength);
+        column.outputWidth = std::max(column.outputWidth, c2->outputWidth);
+    }
+    TableInfo result(table1Name + ", " + table2Name, columns);
+
+    sink.begin((bagOpType == kw_union ? "bag union" : "bag intersect"), result.name, result);
 
-    // output column names
-    std::cout << UNDERLINE;
-    for (const ColumnInfo* column : largerColumns)
-        std::cout << UNDERLINE << std::right << std::setw(column->outputWidth) << column->name << ' ';
-    std::cout << '\n' << CLOSEUNDERLINE;
+    std::vector<char> row(result.rowSize(), '\0');
 
     // bag union
     if (bagOpType == kw_union) {
-        // output first table using larger output width
+        // output first table
         while (table1.nextRow()) {
-            for (const ColumnInfo* column : largerColumns)
-                std::cout << std::right << std::setw(column->outputWidth) << table1.getValueString(column->name) << ' ';
-            std::cout << '\n';
+            copyColumns(table1, result, row);
+            sink.row(row.data());
         }
-        // output second table using larger output width
+        // output second table
         while (table2.nextRow()) {
-            for (const ColumnInfo* column : largerColumns)
-                std::cout << std::right << std::setw(column->outputWidth) << table2.getValueString(column->name) << ' ';
-            std::cout << '\n';
+            copyColumns(table2, result, row);
+            sink.row(row.data());
         }
     }
 
-    // bag intersect
+    // bag intersect, each row of table1 that some row of table2 equals, once, in table1's order
+    // the smaller table's rows are hashed in their canonical form, and the other table's looked up
     else if (bagOpType == kw_intersect)  {
+        std::vector<const ColumnInfo*> columns1, columns2;
+        for (auto& column : result.columns) {
+            columns1.push_back(t1[column.name]);
+            columns2.push_back(t2[column.name]);
+        }
+        IntersectKeys keys(result.rowSize() - 1);
+        std::vector<char> block(BATCH_SIZE * std::max(table1.rowSize, table2.rowSize));
+        std::vector<char> key(keys.keySize);
+
+        // table2 is hashed, and table1 streamed past it
+        if (approximateRows(table2) <= approximateRows(table1)) {
+            table2.reset();
+            while (size_t count = table2.readBlock(block.data(), BATCH_SIZE)) {
+                for (size_t i = 0; i < count; ++i) {
+                    const char* row2 = block.data() + i * table2.rowSize;
+                    if (!row2[0] && canonicalRow(row2, columns2, result, key.data()))
+                        keys.add(key.data());
+                }
+            }
+            keys.finish();
+
+            table1.reset();
+            while (size_t count = table1.readBlock(block.data(), BATCH_SIZE)) {
+                for (size_t i = 0; i < count; ++i) {
+                    const char* row1 = block.data() + i * table1.rowSize;
+                    if (row1[0] || !canonicalRow(row1, columns1, result, key.data()) || !keys.find(key.data()))
+                        continue;
+                    copyColumns(row1, t1, result, row);
+                    sink.row(row.data());
+                }
+            }
+        }
+
+        // table1 is hashed and kept, table2 marks the rows it equals, and then table1's marked rows are output
+        else {
+            std::vector<char> rows1;
+            table1.reset();
+            while (size_t count = table1.readBlock(block.data(), BATCH_SIZE)) {
+                for (size_t i = 0; i < count; ++i) {
+                    const char* row1 = block.data() + i * table1.rowSize;
+                    if (row1[0] || !canonicalRow(row1, columns1, result, key.data()))
+                        continue;
+                    keys.add(key.data());
+                    copyColumns(row1, t1, result, row);
+                    rows1.insert(rows1.end(), row.begin(), row.end());
+                }
+            }
+            keys.finish();
+
+            table2.reset();
+            while (size_t count = table2.readBlock(block.data(), BATCH_SIZE)) {
+                for (size_t i = 0; i < count; ++i) {
+                    const char* row2 = block.data() + i * table2.rowSize;
+                    if (row2[0] || !canonicalRow(row2, columns2, result, key.data()))
+                        continue;
+                    if (bool* matched = keys.find(key.data()))
+                        *matched = true;
+                }
+            }
+
+            for (size_t r = 0; r < keys.size(); ++r)
+                if (*keys.find(keys.keys.data() + r * keys.keySize))
+                    sink.row(rows1.data() + r * row.size());
+        }
+    }
+
+    sink.end();
+}
+
+// a statement compiled once so that it can be run any number of times
+// compiling reads the table headers, opens the table files, and compiles the where clause into a PredicateProgram, so a run only scans
+struct Plan {
+    virtual ~Plan() = default;
+    virtual void run(ResultSink& sink) = 0;
+
+    // the where clause in the order its terms were last evaluated in, for diagnostics. see PredicateProgram::describe()
+    virtual std::string filterOrder() const {
+        return "";
+    }
+
+    // how much the last run's join spilled to disk, for diagnostics. see JoinStats::describe()
+    virtual std::string joinStatistics() const {
+        return "";
+    }
+
+    // how many sorted runs the last run's order clause spilled and merge passes it took, for diagnostics. see SortStats::describe()
+    virtual std::string sortStatistics() const {
+        return "";
+    }
+};
+
+// selection
+// with distinct, the selected rows go through a DistinctSink, which hands on the first of each set of equal rows.
+// with an order clause, they then go through a SortSink, carrying the ordered column after the selected ones if it isn't selected
+struct SelectionPlan : Plan {
+    std::string tableName;
+    TableInfo t;
+    Table table;
+    TableInfo selected;
+    bool distinct;
+    DistinctStats distinctStats; // of the last run
+    std::string orderColumn;     // empty without an order clause
+    bool descending = false;
+    TableInfo carried;           // selected, and the ordered column
+    SortStats sortStats;         // of the last run
+    PredicateProgram program; // empty without a where clause
+    std::vector<char> block;
+    std::vector<uint16_t> selection;
+    Parameters& parameters;
+
+    SelectionPlan(std::shared_ptr<node> selectionRoot, Parameters& parameters)
+        : tableName(selectionRoot->components[1]->value), t(TABLE_DIRECTORY + tableName + FILE_EXTENSION), table(t),
+          distinct(selectionRoot->components[0]->type == kw_distinct), block(BATCH_SIZE * table.rowSize), parameters(parameters) {
+
+        // get a list of all column names to select
+        std::vector<ColumnInfo> selectedColumns;
+        auto columnList = selectionRoot->components[2];
+        // * column list
+        if (columnList->components[0]->type == asterisk)
+            selectedColumns = t.columns;
+        // column list with names
+        else
+            for (auto& selectedColumnNode : columnList->components)
+                selectedColumns.push_back(*t[selectedColumnNode->value]);
+        selected = TableInfo(tableName, selectedColumns);
+
+        auto orderRoot = selectionRoot->components[4];
+        if (orderRoot->type != nullnode) {
+            orderColumn = orderRoot->components[0]->value;
+            descending = orderRoot->components[1]->type == kw_desc;
+            if (std::none_of(selectedColumns.begin(), selectedColumns.end(), [&](const ColumnInfo& c) { return c.name == orderColumn; }))
+                selectedColumns.push_back(*t[orderColumn]);
+        }
+        carried = TableInfo(tableName, selectedColumns);
+
+        auto whereClauseRoot = selectionRoot->components[3];
+        if (whereClauseRoot->type != nullnode)
+            compileProgram(whereClauseRoot->components[0], t, program, parameters);
+    }
+
+    std::string filterOrder() const override {
+        return program.describe();
+    }
+
+    std::string sortStatistics() const override {
+        return sortStats.describe();
+    }
+
+    void run(ResultSink& sink) override {
+        parameters.requireBound();
+        distinctStats = DistinctStats();
+        sortStats = SortStats();
+
+        std::unique_ptr<SortSink> sortedRows;
+        if (!orderColumn.empty())
+            sortedRows = std::make_unique<SortSink>(sink, orderColumn, descending, carried.columns.size() == selected.columns.size() ? nullptr : &selected);
+        ResultSink& sorted = sortedRows ? *sortedRows : sink;
+        std::unique_ptr<DistinctSink> distinctRows;
+        if (distinct)
+            distinctRows = std::make_unique<DistinctSink>(sorted);
+        ResultSink& out = distinctRows ? *distinctRows : sorted;
+
+        out.begin("select from", tableName, carried);
+        // a where clause that can't be true doesn't need the table read at all
+        if (program.alwaysFalse) {
+            out.end();
+            return;
+        }
+
+        std::vector<char> row(carried.rowSize(), '\0');
+        program.open();
+        table.reset();
+        while (size_t count = table.readBlock(block.data(), BATCH_SIZE)) {
+            program.select(block.data(), table.rowSize, count, selection);
+            for (uint16_t i : selection) {
+                copyColumns(block.data() + i * table.rowSize, t, carried, row);
+                out.row(row.data());
+            }
+        }
+        out.end();
+        if (distinctRows)
+            distinctStats = distinctRows->stats;
+        if (sortedRows)
+            sortStats = sortedRows->stats;
+    }
+};
+
+// hands on the rows that pass program, checked a block at a time, to sink
+struct FilteredSink : ResultSink {
+    ResultSink& sink;
+    PredicateProgram& program;
+    unsigned int rowSize = 0;
+    std::vector<char> block;
+    size_t rows = 0;
+    std::vector<uint16_t> selection;
+
+    FilteredSink(ResultSink& sink, PredicateProgram& program) : sink(sink), program(program) {}
+
+    void begin(const std::string& statement, const std::string& tables, const TableInfo& layout) override {
+        rowSize = layout.rowSize();
+        block.resize(BATCH_SIZE * rowSize);
+        rows = 0;
+        sink.begin(statement, tables, layout);
+    }
+
+    void row(const char* rowBytes) override {
+        std::copy(rowBytes, rowBytes + rowSize, block.data() + rows * rowSize);
+        if (++rows == BATCH_SIZE)
+            flush();
+    }
+
+    void end() override {
+        flush();
+        sink.end();
+    }
+
+    void setFormat(const std::string& format) override {
+        sink.setFormat(format);
+    }
+
+    void flush() {
+        if (rows == 0)
+            return;
+        program.select(block.data(), rowSize, rows, selection);
+        for (uint16_t i : selection)
+            sink.row(block.data() + i * rowSize);
+        rows = 0;
+    }
+};
+
+// hands sink the selected columns of each row, in the order they were selected
+struct ProjectedSink : ResultSink {
+    ResultSink& sink;
+    const TableInfo& layout;
+    const RowProjection& projection;
+    std::vector<char> projected;
+
+    ProjectedSink(ResultSink& sink, const TableInfo& layout, const RowProjection& projection) : sink(sink), layout(layout), projection(projection), projected(layout.rowSize(), '\0') {}
+
+    void begin(const std::string& statement, const std::string& tables, const TableInfo& joined) override {
+        sink.begin(statement, tables, layout);
+    }
+
+    void row(const char* rowBytes) override {
+        projection.copy(rowBytes, projected.data());
+        sink.row(projected.data());
+    }
+
+    void end() override {
+        sink.end();
+    }
+
+    void setFormat(const std::string& format) override {
+        sink.setFormat(format);
+    }
+};
+
+// join
+// a where clause is split into its && terms. the terms on one table's columns are checked on that table's rows as the join reads them,
+// so rows they rule out are never indexed or probed, and the terms on more than one table are checked on the joined rows.
+// with a column list, each table is read narrowed to the columns it selects, joins on, or the joined rows are checked on,
+// and the joined rows are narrowed to the selected columns last
+struct JoinPlan : Plan {
+    std::vector<std::string> tableNames;
+    std::vector<TableInfo> joinedTables;
+    std::vector<std::unique_ptr<Table>> tables;
+    std::vector<TableInfo> carried;                                 // by table, the columns read from it
+    std::vector<JoinCondition> conditions;
+    TableInfo joined;                                               // the joined rows, every carried column of each table
+    TableInfo result;                                               // the selected columns
+    RowProjection selection;                                        // joined to result, empty when they're the same
+    std::vector<std::unique_ptr<PredicateProgram>> tableFilters;    // by table, nullptr for none
+    std::unique_ptr<PredicateProgram> joinedFilter;                 // nullptr for none
+    bool hasWhereClause = false;
+    std::vector<uint16_t> rowSelection;
+    JoinStats joinStats;
+    Parameters& parameters;
+
+    JoinPlan(std::shared_ptr<node> joinRoot, Parameters& parameters) : tableNames(joinTableNames(joinRoot)), parameters(parameters) {
+        std::string joinedNames;
+        for (auto& tableName : tableNames) {
+            joinedTables.push_back(TableInfo(TABLE_DIRECTORY + tableName + FILE_EXTENSION));
+            joinedNames += (joinedNames.empty() ? "" : ", ") + tableName;
+        }
+        for (auto& t : joinedTables)
+            tables.push_back(std::make_unique<Table>(t));
+        TableInfo allColumns(joinedNames, joinColumns(joinedTables, joinAliasList(joinRoot)));
+        tableFilters.resize(tables.size());
+
+        // the where clause is on the joined columns, so each table's are a slice of them, laid out the same as in its file
+        std::vector<TableInfo> layouts;
+        std::vector<size_t> tableColumns;
+        auto column = allColumns.columns.begin();
+        for (size_t i = 0; i < joinedTables.size(); ++i) {
+            std::vector<ColumnInfo> columns(column, column + joinedTables[i].columns.size());
+            column += joinedTables[i].columns.size();
+            tableColumns.push_back(columns.size());
+            layouts.push_back(TableInfo(tableNames[i], columns));
+        }
+        // the validator rejects a where clause on a name more than one table has, so every name it uses is here
+        std::map<std::string, std::pair<size_t, size_t>> columnOf = joinedColumnTables(allColumns.columns, tableColumns);
+
+        // the && terms on each table alone, and last the rest
+        std::vector<Condition> filters(tables.size() + 1);
+        for (auto& filter : filters)
+            filter.kind = Condition::And;
+        auto whereClauseRoot = joinWhereClause(joinRoot);
+        bool alwaysFalse = false;
+        if (whereClauseRoot->type != nullnode) {
+            hasWhereClause = true;
+            Condition where = simplify(buildCondition(whereClauseRoot->components[0], false, allColumns), allColumns);
+            alwaysFalse = where.kind == Condition::False;
+            std::vector<Condition> terms;
+            if (where.kind == Condition::And)
+                terms = where.children;
+            else if (where.kind != Condition::True && !alwaysFalse)
+                terms.push_back(where);
+            for (auto& term : terms) {
+                std::vector<std::string> columns;
+                conditionColumns(term, columns);
+                size_t table = columnOf.at(columns[0]).first;
+                for (auto& c : columns)
+                    if (columnOf.at(c).first != table)
+                        table = tables.size();
+                filters[table].children.push_back(term);
+            }
+        }
+
+        // the columns each table carries: the selected ones, the ones joined on, and the ones the joined rows are checked on
+        std::vector<std::pair<size_t, size_t>> selected = joinSelection(joinColumnList(joinRoot), tableNames, joinedTables);
+        std::vector<std::vector<bool>> carries;
+        for (auto& t : joinedTables)
+            carries.push_back(std::vector<bool>(t.columns.size(), false));
+        for (auto& s : selected)
+            carries[s.first][s.second] = true;
+        for (auto& onRoot : joinConditions(joinRoot)) {
+            JoinCondition on = joinCondition(onRoot, tableNames, joinedTables);
+            carries[on.table1][on.column1 - joinedTables[on.table1].columns.data()] = true;
+            carries[on.table2][on.column2 - joinedTables[on.table2].columns.data()] = true;
+        }
+        std::vector<std::string> checkedColumns;
+        conditionColumns(filters.back(), checkedColumns);
+        for (auto& c : checkedColumns)
+            carries[columnOf.at(c).first][columnOf.at(c).second] = true;
+
+        // joined rows are the carried columns of each table in order, and the columns the same as their slice of the joined ones,
+        // by the names they have after aliasing
+        std::vector<ColumnInfo> joinedColumns;
+        std::vector<std::vector<size_t>> joinedIndex(tables.size());
+        for (size_t i = 0; i < joinedTables.size(); ++i) {
+            std::vector<ColumnInfo> columns;
+            for (size_t c = 0; c < joinedTables[i].columns.size(); ++c) {
+                joinedIndex[i].push_back(joinedColumns.size());
+                if (!carries[i][c])
+                    continue;
+                columns.push_back(joinedTables[i].columns[c]);
+                joinedColumns.push_back(layouts[i].columns[c]);
+            }
+            carried.push_back(TableInfo(tableNames[i], columns));
+        }
+        for (auto& onRoot : joinConditions(joinRoot))
+            conditions.push_back(joinCondition(onRoot, tableNames, carried));
+        joined = TableInfo(joinedNames, joinedColumns);
+
+        std::vector<ColumnInfo> resultColumns;
+        bool inJoinedOrder = selected.size() == joinedColumns.size();
+        for (size_t s = 0; s < selected.size(); ++s) {
+            size_t index = joinedIndex[selected[s].first][selected[s].second];
+            resultColumns.push_back(joined.columns[index]);
+            inJoinedOrder = inJoinedOrder && index == s;
+        }
+        result = TableInfo(joinedNames, resultColumns);
+        if (!inJoinedOrder)
+            for (size_t s = 0; s < selected.size(); ++s)
+                selection.add(joined.columns[joinedIndex[selected[s].first][selected[s].second]], result.columns[s]);
+
+        if (alwaysFalse) {
+            joinedFilter = std::make_unique<PredicateProgram>();
+            joinedFilter->alwaysFalse = true;
+            return;
+        }
+        for (size_t i = 0; i <= tables.size(); ++i) {
+            if (filters[i].children.empty())
+                continue;
+            auto program = std::make_unique<PredicateProgram>();
+            compileProgram(toNode(filters[i]), i < tables.size() ? layouts[i] : joined, *program, parameters);
+            (i < tables.size() ? tableFilters[i] : joinedFilter) = std::move(program);
+        }
+    }
+
+    // the terms of the where clause checked on each table, then on the joined rows
+    std::string filterOrder() const override {
+        std::string description;
+        for (size_t i = 0; i <= tables.size(); ++i) {
+            const PredicateProgram* program = i < tables.size() ? tableFilters[i].get() : joinedFilter.get();
+            if (program && !program->describe().empty())
+                description += (description.empty() ? "" : "; ") + (i < tables.size() ? tableNames[i] : "joined") + ": " + program->describe();
+        }
+        return description;
+    }
+
+    std::string joinStatistics() const override {
+        return joinStats.describe();
+    }
+
+    void run(ResultSink& sink) override {
+        if (hasWhereClause)
+            parameters.requireBound();
+        joinStats = JoinStats();
+
+        std::vector<JoinInput> inputs;
+        for (size_t i = 0; i < tables.size(); ++i) {
+            if (tableFilters[i])
+                tableFilters[i]->open();
+            inputs.push_back(JoinInput(*tables[i], tableFilters[i].get(), &carried[i]));
+        }
+        std::unique_ptr<ProjectedSink> projected;
+        if (!selection.runs.empty())
+            projected = std::make_unique<ProjectedSink>(sink, result, selection);
+        ResultSink& selected = projected ? *projected : sink;
+        std::unique_ptr<FilteredSink> filtered;
+        if (joinedFilter) {
+            joinedFilter->open();
+            filtered = std::make_unique<FilteredSink>(selected, *joinedFilter);
+        }
+        ResultSink& out = filtered ? *filtered : selected;
+
+        out.begin("join", joined.name, joined);
+        // a where clause that can't be true doesn't need the tables read at all
+        if (joinedFilter && joinedFilter->alwaysFalse) {
+            out.end();
+            return;
+        }
+
+        // more than two tables, or more than one on expr, run as a pipeline
+        if (tables.size() > 2 || conditions.size() > 1) {
+            std::vector<JoinInput*> pipelined;
+            for (auto& input : inputs)
+                pipelined.push_back(&input);
+            joinPipeline(pipelined, conditions, out);
+            out.end();
+            return;
+        }
+
+        // the on expr may name table2's column first
+        JoinCondition on = conditions[0];
+        if (on.table1 != 0)
+            on = JoinCondition{0, on.column2, mirrored(on.op), 1, on.column1};
+
+        // a joined row is table1's row followed by table2's, each without its delete byte
+        std::vector<char> row(joined.rowSize(), '\0');
+
+        if (indexJoinable(on.op)) {
+            indexJoin(inputs[0], *on.column1, inputs[1], *on.column2, on.op, row, out, joinStats);
+            out.end();
+            return;
+        }
+
+        // output the join
+        Table& table1 = *tables[0];
+        Table& table2 = *tables[1];
+        table1.reset();
+        table2.reset();
         while (table1.nextRow()) {
-            // compare each row of table1 to every row of table2 until a match is found
+            if (!passes(0, table1.currentRow))
+                continue;
             while (table2.nextRow()) {
                 // match not found, skip
-                if (!table1.compareRow(table2))
+                if (!table1.compareCell(on.column1->name, on.op, table2, on.column2->name) || !passes(1, table2.currentRow))
                     continue;
 
-                // match found. output & reset table2
-                for (const ColumnInfo* column : largerColumns)
-                    std::cout << std::right << std::setw(column->outputWidth) << table1.getValueString(column->name) << ' ';
-                std::cout << '\n';
-
-                table2.reset();
-                break;
+                // match found, output row. table1's row goes in second, over the delete byte of table2's
+                inputs[1].project(table2.currentRow, row.data() + inputs[0].rowSize - 1);
+                inputs[0].project(table1.currentRow, row.data());
+                out.row(row.data());
+                
+                // dont break, continue looking for matches
             }
-            // match never found, reset table2
+            // reached the end of table 2, reset
             table2.reset();
         }
+
+        out.end();
     }
+
+    // whether a row of table i passes its filter
+    bool passes(size_t i, const char* row) {
+        if (!tableFilters[i])
+            return true;
+        tableFilters[i]->select(row, tables[i]->rowSize, 1, rowSelection);
+        return !rowSelection.empty();
+    }
+};
+
+// a join with no parameters, adding what it spilled to stats
+void executeJoin(std::shared_ptr<node> joinRoot, ResultSink& sink, JoinStats* stats = nullptr) {
+    Parameters parameters;
+    JoinPlan plan(joinRoot, parameters);
+    plan.run(sink);
+    if (stats)
+        *stats = plan.joinStats;
 }
 
-// execute selection
-void select(std::shared_ptr<node> selectionRoot) {
-    std::string tableName = selectionRoot->components[1]->value;
-    TableInfo t(TABLE_DIRECTORY + tableName + FILE_EXTENSION);
+// mark rows for deletion
+struct DeletionPlan : Plan {
+    TableInfo t;
+    Table table;
+    PredicateProgram program;
+    std::vector<char> block;
+    std::vector<uint16_t> selection;
+    Parameters& parameters;
+
+    DeletionPlan(std::shared_ptr<node> deletionRoot, Parameters& parameters)
+        : t(TABLE_DIRECTORY + deletionRoot->components[0]->value + FILE_EXTENSION), table(t), block(BATCH_SIZE * table.rowSize), parameters(parameters) {
+        compileProgram(deletionRoot->components[1]->components[0], t, program, parameters);
+    }
 
-    // get a list of all column names to select
-    std::vector<const ColumnInfo*> selectedColumns;
-    auto columnList = selectionRoot->components[2];
-    // * column list
-    if (columnList->components[0]->type == asterisk)
-        for (auto& column : t.columns)
-            selectedColumns.push_back(&column);
-    // column list with names
-    else
-        for (auto& selectedColumnNode : columnList->components)
-            selectedColumns.push_back(t[selectedColumnNode->value]);
-
-    // output statement
-    std::cout << "\n\033[0;34m$ select from \033[0;32m" << tableName << "\033[0m" << '\n';
-
-    // output column names
-    std::cout << UNDERLINE;
-    for (const ColumnInfo* column : selectedColumns)
-        std::cout << UNDERLINE << std::right << std::setw(column->outputWidth) << column->name << ' ';
-    std::cout << '\n' << CLOSEUNDERLINE;
-
-    Table table(t);
-
-    // no where clause
-    auto whereClauseRoot = selectionRoot->components[3];
-    if (whereClauseRoot->type == nullnode) {
-        while (table.nextRow()) {
-            for (const ColumnInfo* column : selectedColumns)
-                std::cout << std::right << std::setw(column->outputWidth) << table.getValueString(column->name) << ' ';
-            std::cout << '\n';
-        }
-        return;
-    }
-    // where clause
-    auto boolExprRoot = whereClauseRoot->components[0];
-    std::shared_ptr<EvaluationNode> evaluationRoot = convert(boolExprRoot, table, t);
-    // @TODO evaluationRoot->bind(eIt);
-    while (table.nextRow()) {
-        if (!evaluationRoot->evaluate())
-            continue;
-        for (const ColumnInfo* column : selectedColumns)
-            std::cout << std::right << std::setw(column->outputWidth) << table.getValueString(column->name) << ' ';
-        std::cout << '\n';
+    std::string filterOrder() const override {
+        return program.describe();
     }
 
-}
+    void run(ResultSink& sink) override {
+        parameters.requireBound();
+        if (program.alwaysFalse)
+            return;
+
+        bool wrote = false;
+        program.open();
+        table.reset();
+        while (size_t count = table.readBlock(block.data(), BATCH_SIZE)) {
+            program.select(block.data(), table.rowSize, count, selection);
+            for (uint16_t i : selection) {
+                table.seekToBlockRow(i);
+                table.markForDeletion();
+            }
+            wrote = wrote || !selection.empty();
+        }
+        if (wrote) {
+            table.file.flush();
+            SUBQUERY_CACHE.tableWritten(t.name);
+        }
+    }
+};
 
-// used in executeUpdate()
+// used in UpdatePlan
 struct WriteData {
-    std::string& value;
+    const std::string& value;
     element_type type;
 };
 
 // update an entry
-void executeUpdate(std::shared_ptr<node> updateRoot) {
-    std::string tableName = updateRoot->components[0]->value;
-    TableInfo t(TABLE_DIRECTORY + tableName + FILE_EXTENSION);
-    auto ColumnValueList = updateRoot->components[1];
-
-    // build list of columns and values to write
-    std::map<std::string, WriteData> mentionedNameToWriteData;
-    for (auto& columnValuePair : ColumnValueList->components )
-        // insert(name, WriteData{value, type})                                          
-        mentionedNameToWriteData.insert({columnValuePair->components[0]->value, WriteData{columnValuePair->components[1]->value, columnValuePair->components[1]->type}});   
-
-    Table table(t);
-    auto boolExprRoot = updateRoot->components[2];
-    std::shared_ptr<EvaluationNode> evaluationRoot =  convert(boolExprRoot->components[0], table, t);
-    while (table.nextRow()) {
-        if(!evaluationRoot->evaluate())
-            continue;
-       
-        for (const auto& [name, data] : mentionedNameToWriteData) {
-            switch (data.type) {
-                case int_literal:
-                    table.setInt(name, stoi(data.value));
-                    break;
-                case float_literal:
-                    table.setFloat(name, stof(data.value));
-                    break;
-                case chars_literal:
-                    table.setChars(name, data.value);
-                    break;
-                case bool_literal:
-                    table.setBool(name, data.value == "true");
-                    break;
-                case kw_null:
-                    table.setNull(name);
-                    break;
-                default:
-                    std::cout << "Error while executing an update. Column cannot be a type other than a literal.\n";
-                    exit(1);
+struct UpdatePlan : Plan {
+    TableInfo t;
+    Table table;
+    std::shared_ptr<node> columnValueListRoot;
+    PredicateProgram program;
+    std::vector<char> block;
+    std::vector<uint16_t> selection;
+    Parameters& parameters;
+
+    UpdatePlan(std::shared_ptr<node> updateRoot, Parameters& parameters)
+        : t(TABLE_DIRECTORY + updateRoot->components[0]->value + FILE_EXTENSION), table(t), columnValueListRoot(updateRoot->components[1]),
+          block(BATCH_SIZE * table.rowSize), parameters(parameters) {
+        compileProgram(updateRoot->components[2]->components[0], t, program, parameters);
+    }
+
+    std::string filterOrder() const override {
+        return program.describe();
+    }
+
+    void run(ResultSink& sink) override {
+        parameters.requireBound();
+        if (program.alwaysFalse)
+            return;
+
+        // build list of columns and values to write
+        std::map<std::string, WriteData> mentionedNameToWriteData;
+        for (auto& columnValuePair : columnValueListRoot->components) {
+            auto valueNode = columnValuePair->components[1];
+            // a parameter is written just like the literal bound to it
+            if (valueNode->type == parameter) {
+                const Parameter& p = parameters.get(stoi(valueNode->value));
+                mentionedNameToWriteData.insert({columnValuePair->components[0]->value, WriteData{p.value, p.boundType}});
             }
+            // insert(name, WriteData{value, type})
+            else
+                mentionedNameToWriteData.insert({columnValuePair->components[0]->value, WriteData{valueNode->value, valueNode->type}});
+        }
+
+        bool wrote = false;
+        program.open();
+        table.reset();
+        while (size_t count = table.readBlock(block.data(), BATCH_SIZE)) {
+            program.select(block.data(), table.rowSize, count, selection);
+            wrote = wrote || !selection.empty();
+            for (uint16_t i : selection) {
+                table.seekToBlockRow(i);
+                for (const auto& [name, data] : mentionedNameToWriteData) {
+                    switch (data.type) {
+                        case int_literal:
+                            table.setInt(name, stoi(data.value));
+                            break;
+                        case float_literal:
+                            table.setFloat(name, stof(data.value));
+                            break;
+                        case chars_literal:
+                            table.setChars(name, data.value);
+                            break;
+                        case bool_literal:
+                            table.setBool(name, data.value == "true");
+                            break;
+                        case kw_null:
+                            table.setNull(name);
+                            break;
+                        default:
+                            throw QueryError() << "Error while executing an update. Column cannot be a type other than a literal.\n";
+                    }
+                }
+            }
+        }
+        if (wrote) {
+            table.file.flush();
+            SUBQUERY_CACHE.tableWritten(t.name);
         }
     }
-}
+};
 
 // used in insert to write a value given a string from the AST
 void writeValue(const std::string& value, const ColumnInfo& c, std::ofstream& file) {
@@ -293,7 +865,12 @@ void writeValue(const std::string& value, const ColumnInfo& c, std::ofstream& fi
 
 // append data to the end of the file
 // @TODO, if there are rows marked for deletion, insert there instead
-void insert(std::shared_ptr<node> insertRoot) {
+void insert(std::shared_ptr<node> insertRoot, const Parameters& parameters) {
+
+    // look up every parameter first, so a missing value can't leave half a row behind
+    for (auto& columnValuePair : insertRoot->components[1]->components)
+        if (columnValuePair->components[1]->type == parameter)
+            parameters.get(stoi(columnValuePair->components[1]->value));
 
     std::string tableName = insertRoot->components[0]->value;
     std::ofstream file(TABLE_DIRECTORY + tableName + FILE_EXTENSION, std::ios_base::app);
@@ -312,8 +889,16 @@ void insert(std::shared_ptr<node> insertRoot) {
             // column mentioned
             if (columnValuePair->components[0]->value == c.name) {
                 mentioned = true;
+                // a parameter is written just like the literal bound to it
+                element_type valueType = columnValuePair->components[1]->type;
+                std::string value = columnValuePair->components[1]->value;
+                if (valueType == parameter) {
+                    const Parameter& p = parameters.get(stoi(value));
+                    valueType = p.boundType;
+                    value = p.value;
+                }
                 // null insert, write null byte as 1, fill rest as 0
-                if (columnValuePair->components[1]->type == kw_null) {
+                if (valueType == kw_null) {
                         file << static_cast<unsigned char>(0b1);
                     if (c.type == chars_literal)
                         numBytesToWrite = c.charsLength;
@@ -325,7 +910,7 @@ void insert(std::shared_ptr<node> insertRoot) {
                 // value to insert
                 else {
                     file << static_cast<unsigned char>(0b0);
-                    writeValue(columnValuePair->components[1]->value, c, file);
+                    writeValue(value, c, file);
                 }
             }
         }
@@ -342,11 +927,14 @@ void insert(std::shared_ptr<node> insertRoot) {
                 file << static_cast<unsigned char>(0b0);
         }
     }
+    file.close();
+    SUBQUERY_CACHE.tableWritten(tableName);
 }
 
 // drop a table
 void executeDrop(std::shared_ptr<node> dropRoot)  {
-    std::filesystem::remove("../tables/" + dropRoot->components[0]->value + ".ftbl");
+    std::filesystem::remove(TABLE_DIRECTORY + dropRoot->components[0]->value + FILE_EXTENSION);
+    SUBQUERY_CACHE.tableWritten(dropRoot->components[0]->value);
 }
 
 // given a TableInfo, write a header for a table that does not exist yet
@@ -373,257 +961,42 @@ void writeHeader(const TableInfo& table) {
     }
 
     header.close();
+    SUBQUERY_CACHE.tableWritten(table.name);
 }
 
-// called in define()
-void defineSelection(std::shared_ptr<node> definitionRoot) {
-    std::string definedTableName = definitionRoot->components[1]->value;
-    std::ofstream definedFile(TABLE_DIRECTORY + definedTableName + FILE_EXTENSION);
-
-    auto selectionRoot = definitionRoot->components[2];
-    auto selectedColumnListRoot = selectionRoot->components[2];
-    std::string selectedTableName = selectionRoot->components[1]->value;
-    TableInfo selectedInfo(TABLE_DIRECTORY + selectedTableName + FILE_EXTENSION);
-
-    // figure out which columns were selected
-    std::vector<ColumnInfo> definedColumns;
-    // *
-    if (selectedColumnListRoot->components[0]->type == asterisk)
-        definedColumns = selectedInfo.columns;
-    // column names
-    else
-        for (auto& columnNode : selectedColumnListRoot->components)
-            definedColumns.push_back(*selectedInfo[columnNode->value]);
-
-    // write header
-    TableInfo definedInfo(definedTableName, definedColumns);
-    writeHeader(definedInfo);
-
-    Table selectedTable(selectedInfo);
-    Table definedTable(definedInfo);
-
-    auto whereClauseRoot = selectionRoot->components[3];
-    
-    // no where clause
-    if (whereClauseRoot->type == nullnode) {
-        while (selectedTable.nextRow()) {
-            char deleteByte = '\0';
-            definedTable.appendBytes(&deleteByte, 1);
-            for (const ColumnInfo& column : definedColumns) {
-                char* selectedBytes = selectedTable.getBytes(column.name);
-                definedTable.appendBytes(selectedBytes, column.bytesNeeded);
-            }
-        }
-    }
-    // where clause
-    else if (whereClauseRoot->type == where_clause) {
+// writes the rows of a selection, bag operation, or join into a new table. used in define()
+struct TableWriter : ResultSink {
+    std::string tableName;
+    std::ofstream file;
+    int rowSize = 0;
 
-        std::shared_ptr<EvaluationNode> evaluationRoot = convert(whereClauseRoot->components[0], selectedTable, selectedInfo);
-        while (selectedTable.nextRow()) {
-            if (!evaluationRoot->evaluate())
-                continue;
+    TableWriter(const std::string& tableName) : tableName(tableName) {}
 
-            char deleteByte = '\0';
-            definedTable.appendBytes(&deleteByte, 1);
+    void begin(const std::string& statement, const std::string& tables, const TableInfo& layout) override {
+        // write header
+        TableInfo definedInfo(tableName, layout.columns);
+        writeHeader(definedInfo);
+        rowSize = definedInfo.rowSize();
 
-            for (const ColumnInfo& column : definedColumns) {
-                char* selectedBytes = selectedTable.getBytes(column.name);
-                definedTable.appendBytes(selectedBytes, column.bytesNeeded);
-            }
-        }
+        file.open(TABLE_DIRECTORY + tableName + FILE_EXTENSION, std::ios_base::app | std::ios_base::binary);
     }
-}
-
-// called in define()
-void defineBagOp(std::shared_ptr<node> definitionRoot) {
-    std::string definedTableName = definitionRoot->components[1]->value;
-    std::ofstream definedFile(TABLE_DIRECTORY + definedTableName + FILE_EXTENSION);
 
-    auto bagOpRoot = definitionRoot->components[2];
-    element_type opType = bagOpRoot->components[0]->type;
-    TableInfo table1Info(TABLE_DIRECTORY + bagOpRoot->components[1]->value + FILE_EXTENSION);
-    TableInfo table2Info(TABLE_DIRECTORY + bagOpRoot->components[2]->value + FILE_EXTENSION);
-
-    std::vector<ColumnInfo> definedColumns = table1Info.columns;
-    // for each chars column, make sure that the larger one is put into workingColumns  
-    for (auto& workingColumn : definedColumns) {
-        if (workingColumn.type == chars_literal) {
-            auto c2 = find(workingColumn.name, table2Info.columns);
-            // set longer chars length
-            workingColumn.charsLength  = ( c2->charsLength > workingColumn.charsLength ? c2->charsLength : workingColumn.charsLength );
-            // set longer bytes needed
-            workingColumn.bytesNeeded  = ( c2->bytesNeeded > workingColumn.bytesNeeded ? c2->bytesNeeded : workingColumn.bytesNeeded );
-        }
+    void row(const char* rowBytes) override {
+        file.write(rowBytes, rowSize);
     }
 
-    // write table header
-    TableInfo definedInfo(definedTableName, definedColumns);
-    writeHeader(definedInfo);
-
-    Table table1(table1Info);
-    Table table2(table2Info);
-    Table definedTable(definedInfo);
-
-    // bag union
-    if (opType == kw_union) {
-        // output first table using larger output width
-        while (table1.nextRow()) {
-
-            // set row undeleted
-            char deleteByte = '\0';
-            definedTable.appendBytes(&deleteByte, 1);
-
-            for (const ColumnInfo& column : definedColumns) {
-
-                char* columnBytes = table1.getBytes(column.name);
-                int table1BytesNeeded = table1.t[column.name]->bytesNeeded;
-                definedTable.appendBytes(columnBytes, table1BytesNeeded);
-
-                // pad shorter chars columns
-                if (table1.t[column.name]->type == chars_literal && table1BytesNeeded < column.bytesNeeded) {
-                    int paddingLength = column.bytesNeeded - table1BytesNeeded;
-                    for (int i = 0; i < paddingLength; ++i) {
-                        char nullByte = '\0';
-                        definedTable.appendBytes(&nullByte, 1);
-                    }
-                }
-            }
-        }
-        // output second table using larger output width
-        while (table2.nextRow()) {
-
-            // set row undeleted
-            char deleteByte = '\0';
-            definedTable.appendBytes(&deleteByte, 1);
-
-            for (const ColumnInfo& column : definedColumns) {
-
-                char* columnBytes = table2.getBytes(column.name);
-                int table2BytesNeeded = table2.t[column.name]->bytesNeeded;
-                definedTable.appendBytes(columnBytes, table2BytesNeeded);
-
-                // pad shorter chars columns
-                if (table2.t[column.name]->type == chars_literal && table2BytesNeeded < column.bytesNeeded) {
-                    int paddingLength = column.bytesNeeded - table2BytesNeeded;
-                    for (int i = 0; i < paddingLength; ++i) {
-                        char nullByte = '\0';
-                        definedTable.appendBytes(&nullByte, 1);
-                    }
-                }
-            }
-        }
+    void end() override {
+        file.close();
+        SUBQUERY_CACHE.tableWritten(tableName);
     }
-
-    // bag intersect
-    else if (opType == kw_intersect)  {
-        while (table1.nextRow()) {
-            // compare each row of table1 to every row of table2 until a match is found
-            while (table2.nextRow()) {
-                // match not found, skip
-                if (!table1.compareRow(table2))
-                    continue;
-
-                // set row undeleted
-                char deleteByte = '\0';
-                definedTable.appendBytes(&deleteByte, 1);
-
-                // match found. output & reset table2
-                for (const ColumnInfo& column : definedColumns) {
-                    char* columnBytes;
-                    // for chars, just pick the bytes from the longer column. we know they're the same
-                    if (column.type == chars_literal)
-                        columnBytes = ( table1.t[column.name]->bytesNeeded > table2.t[column.name]->bytesNeeded ? table1.getBytes(column.name) : table2.getBytes(column.name) );
-                    else
-                        columnBytes = table1.getBytes(column.name);
-
-                    definedTable.appendBytes(columnBytes, column.bytesNeeded);
-                }
-
-                table2.reset();
-                break;
-            }
-            // match never found, reset table2
-            table2.reset();
-        }
-    }
-}
-
-// called in define()
-void defineJoin(std::shared_ptr<node> definitionRoot) {
-    std::string definedTableName = definitionRoot->components[1]->value;
-    std::ofstream definedFile(TABLE_DIRECTORY + definedTableName + FILE_EXTENSION);
-
-    auto joinRoot = definitionRoot->components[2];
-    std::string table1Name = joinRoot->components[0]->value;
-    std::string table2Name = joinRoot->components[1]->value;
-    TableInfo table1Info(TABLE_DIRECTORY + table1Name + FILE_EXTENSION);
-    TableInfo table2Info(TABLE_DIRECTORY + table2Name + FILE_EXTENSION);
-
-    auto onRoot = joinRoot->components[2];
-    auto aliasListRoot = joinRoot->components[3];
-    auto joinedColumn1Name = split(onRoot->components[0]->value);
-    auto joinedColumn2Name = split(onRoot->components[2]->value);
-    element_type operation = onRoot->components[1]->type;
-
-    std::vector<ColumnInfo> definedColumns;
-    // same as validation to find column names
-    // build map from table.column name to alias
-    std::map<std::string, std::string> nameToAlias;
-    for (auto& aliasRoot : aliasListRoot->components)
-        nameToAlias.insert({aliasRoot->components[0]->value, aliasRoot->components[1]->value});
-
-    // go through columns of each table
-    for (const auto& t : {&table1Info, &table2Info}) {
-        for (const ColumnInfo& c : t->columns) {
-            std::string aliasName;                
-            // no alias, add original name
-            if (std::find_if(nameToAlias.begin(), nameToAlias.end(), [&t, &c, &aliasName](std::pair<std::string, std::string> nameToAlias){aliasName = nameToAlias.second; return nameToAlias.first == t->name + '.' + c.name;}) == nameToAlias.end())
-                definedColumns.push_back(ColumnInfo(c));
-            // otherwise, add the alias as the name instead
-            else
-                definedColumns.push_back(ColumnInfo(aliasName, c.type, c.charsLength));
-        }
-    }
-
-    // write header of defined table file
-    TableInfo definedInfo(definedTableName, definedColumns);
-    writeHeader(definedInfo);
-    Table definedTable(definedInfo);
-
-    Table table1(table1Info);
-    Table table2(table2Info);
-
-    // output the join
-    while (table1.nextRow()) {
-        while (table2.nextRow()) {
-            // match not found, skip
-            if (!table1.compareCell(joinedColumn1Name.second, operation, table2, joinedColumn2Name.second))
-                continue;
-
-            // set new row as undeleted
-            char deleteByte = '\0';
-            definedTable.appendBytes(&deleteByte, 1);
-
-            // match found, output row
-            for (const ColumnInfo column : table1Info.columns) {
-                char* entryBytes = table1.getBytes(column.name);
-                definedTable.appendBytes(entryBytes, column.bytesNeeded);
-            }
-            for (const ColumnInfo column : table2Info.columns) {
-                char* entryBytes = table2.getBytes(column.name);
-                definedTable.appendBytes(entryBytes, column.bytesNeeded);
-            }
-            
-            // dont break, continue looking for matches
-        }
-        // reached the end of table 2, reset
-        table2.reset();
-    }
-}
+};
 
 // define a table
 // contains the logic for defining from column, type list
-void define(std::shared_ptr<node> definitionRoot) {
+void define(std::shared_ptr<node> definitionRoot, Parameters& parameters, JoinStats* joinStats = nullptr) {
+
+    std::string definedTableName = definitionRoot->components[1]->value;
+    TableWriter writer(definedTableName);
 
     switch (definitionRoot->components[2]->type) {
         case col_type_list: {
@@ -633,63 +1006,99 @@ void define(std::shared_ptr<node> definitionRoot) {
         break;
         
         case selection:
-            defineSelection(definitionRoot);
+            SelectionPlan(definitionRoot->components[2], parameters).run(writer);
         break;
 
         case bag_op:
-            defineBagOp(definitionRoot);
+            executeBagOp(definitionRoot->components[2], writer);
         break;
 
-        case join:
-            defineJoin(definitionRoot);
+        case join: {
+            JoinPlan plan(definitionRoot->components[2], parameters);
+            plan.run(writer);
+            if (joinStats)
+                *joinStats = plan.joinStats;
+        }
         break;
 
         default:
-            std::cout << "Defined a table other than from a column-type list, selection, bag operation, or join. There is likely an issue in the parser. Ignoring.\n";
-            exit(1);
+            throw QueryError() << "Defined a table other than from a column-type list, selection, bag operation, or join. There is likely an issue in the parser. Ignoring.\n";
     }
 }
 
-void execute(std::shared_ptr<node> scriptRoot) {
-    for (auto& statementRoot: scriptRoot->components) {
-        switch (statementRoot->type) {
+// statements with no where clause have nothing worth compiling ahead of time, so they run straight from the syntax tree
+struct DirectPlan : Plan {
+    std::shared_ptr<node> statementRoot;
+    Parameters& parameters;
 
-            case join:
-                executeJoin(statementRoot);
-                break;
+    JoinStats joinStats;
 
-            case deletion:
-                executeDeletion(statementRoot);
-                break;
+    DirectPlan(std::shared_ptr<node> statementRoot, Parameters& parameters) : statementRoot(statementRoot), parameters(parameters) {}
 
-            case update:
-                executeUpdate(statementRoot);
-                break;
-            
-            case bag_op:
-                executeBagOp(statementRoot);
-                break;
+    void run(ResultSink& sink) override {
+        joinStats = JoinStats();
+        switch (statementRoot->type) {
 
-            case selection:
-                select(statementRoot);
+            case bag_op:
+                executeBagOp(statementRoot, sink);
                 break;
 
             case definition:
-                define(statementRoot);
+                define(statementRoot, parameters, &joinStats);
                 break;
 
             case insertion:
-                insert(statementRoot);
+                insert(statementRoot, parameters);
                 break;
             
             case drop:
                 executeDrop(statementRoot);
                 break;
 
+            case output:
+                sink.setFormat(statementRoot->components[0]->value);
+                break;
+
             default:
-                std::cout << "Unknown statement type to execute.\n";
+                throw QueryError() << "Unknown statement type to execute.\n";
         }
     }
+    std::string joinStatistics() const override {
+        return joinStats.describe();
+    }
+};
+
+// compile one statement. parameters must outlive the plan, binding a value to it updates the plan in place
+std::unique_ptr<Plan> compile(std::shared_ptr<node> statementRoot, Parameters& parameters) {
+    switch (statementRoot->type) {
+
+        case selection:
+            return std::make_unique<SelectionPlan>(statementRoot, parameters);
+
+        case deletion:
+            return std::make_unique<DeletionPlan>(statementRoot, parameters);
+
+        case update:
+            return std::make_unique<UpdatePlan>(statementRoot, parameters);
+
+        case join:
+            return std::make_unique<JoinPlan>(statementRoot, parameters);
+
+        default:
+            return std::make_unique<DirectPlan>(statementRoot, parameters);
+    }
+}
+
+// execute one statement of a script, handing any resulting rows to sink
+void executeStatement(std::shared_ptr<node> statementRoot, ResultSink& sink, Parameters& parameters) {
+    compile(statementRoot, parameters)->run(sink);
+}
+
+// nothing is bound when running a whole script, so a statement using ?N fails when it runs
+void execute(std::shared_ptr<node> scriptRoot, ResultSink& sink) {
+    Parameters parameters;
+    for (auto& statementRoot: scriptRoot->components)
+        executeStatement(statementRoot, sink, parameters);
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,493 @@
+// femtoql.cpp
+
+// the library's only translation unit. the engine is header-only, so it is all compiled in here behind femtoql.hpp
+
+#include <iostream>
+#include <filesystem>
+#include <memory>
+#include <charconv>
+#include <thread>
+#include "femtoql.hpp"
+#include "token.hpp"
+#include "tokenize.hpp"
+#include "parser.hpp"
+#include "validate.hpp"
+#include "execute.hpp"
+#include "Batch.hpp"
+#include "BatchQueue.hpp"
+#include "Output.hpp"
+
+namespace femtoql {
+
+// QueryError messages are written for the terminal, drop the trailing newline
+static Status toStatus(const std::exception& e) {
+    std::string message = e.what();
+    while (!message.empty() && message.back() == '\n')
+        message.pop_back();
+    return Status::error(message);
+}
+
+// STREAM
+
+// runs a plan on its own thread, feeding its rows into a queue a batch at a time
+struct Stream {
+    BatchQueue queue;
+    std::thread producer;
+
+    Stream(Plan& plan) : producer([this, &plan]{
+        Batcher batcher(queue);
+        try {
+            plan.run(batcher);
+            queue.finish(nullptr);
+        }
+        catch (const BatchQueue::Cancelled&) {
+            queue.finish(nullptr);
+        }
+        catch (...) {
+            queue.finish(std::current_exception());
+        }
+    }) {}
+
+    // let the plan run to the end right now, keeping the rest of its batches
+    void drain() {
+        queue.drain();
+        if (producer.joinable())
+            producer.join();
+    }
+
+    void rethrowIfFailed() {
+        if (queue.error)
+            std::rethrow_exception(queue.error);
+    }
+
+    ~Stream() {
+        queue.cancel();
+        if (producer.joinable())
+            producer.join();
+    }
+};
+
+// a cursor still being read from may be using the same tables, so let it finish before running anything else
+static void drain(std::weak_ptr<Stream>& streaming) {
+    if (auto stream = streaming.lock())
+        stream->drain();
+    streaming.reset();
+}
+
+// CURSOR
+
+struct Cursor::Impl {
+    std::shared_ptr<Stream> stream; // nullptr once every batch has been read
+    std::vector<ColumnInfo> columns;
+    Batch batch;
+    size_t current = 0; // row of batch that the getters read
+    size_t nextRow = 0; // row of batch that next() moves to
+    Status status;
+
+    void clear() {
+        stream.reset();
+        columns.clear();
+        batch = Batch();
+        current = 0;
+        nextRow = 0;
+        status = Status::success();
+    }
+
+    void start(std::shared_ptr<Stream> started) {
+        stream = started;
+        columns = stream->queue.layout.columns;
+    }
+
+    // move to the next batch, false once there are no more
+    bool fetch() {
+        if (stream && stream->queue.pop(batch)) {
+            current = 0;
+            nextRow = 0;
+            return true;
+        }
+
+        if (stream) {
+            try {
+                stream->rethrowIfFailed();
+            }
+            catch (const std::exception& e) {
+                status = toStatus(e);
+            }
+            stream.reset();
+        }
+        batch.clear();
+        current = 0;
+        nextRow = 0;
+        return false;
+    }
+
+    const ColumnVector& column(size_t column) const {
+        return batch.columns.at(column);
+    }
+};
+
+Cursor::Cursor() : impl(std::make_unique<Impl>()) {}
+Cursor::~Cursor() = default;
+Cursor::Cursor(Cursor&&) = default;
+Cursor& Cursor::operator=(Cursor&&) = default;
+
+bool Cursor::next() {
+    while (impl->nextRow == impl->batch.size) {
+        if (!impl->fetch())
+            return false;
+    }
+    impl->current = impl->nextRow++;
+    return true;
+}
+
+bool Cursor::nextBatch() {
+    return impl->fetch();
+}
+
+size_t Cursor::batchSize() const {
+    return impl->batch.size;
+}
+
+Status Cursor::status() const {
+    return impl->status;
+}
+
+size_t Cursor::columnCount() const {
+    return impl->columns.size();
+}
+
+const std::string& Cursor::columnName(size_t column) const {
+    return impl->columns.at(column).name;
+}
+
+ColumnType Cursor::columnType(size_t column) const {
+    switch (impl->columns.at(column).type) {
+        case int_literal: return ColumnType::Int;
+        case float_literal: return ColumnType::Float;
+        case chars_literal: return ColumnType::Chars;
+        default: return ColumnType::Bool;
+    }
+}
+
+bool Cursor::isNull(size_t column) const {
+    return impl->column(column).nulls[impl->current];
+}
+
+int Cursor::getInt(size_t column) const {
+    return impl->column(column).ints[impl->current];
+}
+
+float Cursor::getFloat(size_t column) const {
+    return impl->column(column).floats[impl->current];
+}
+
+std::string Cursor::getChars(size_t column) const {
+    return impl->column(column).getChars(impl->current);
+}
+
+bool Cursor::getBool(size_t column) const {
+    return impl->column(column).bools[impl->current];
+}
+
+const uint8_t* Cursor::nulls(size_t column) const {
+    return impl->column(column).nulls.data();
+}
+
+const int* Cursor::ints(size_t column) const {
+    return impl->column(column).ints.data();
+}
+
+const float* Cursor::floats(size_t column) const {
+    return impl->column(column).floats.data();
+}
+
+const uint8_t* Cursor::bools(size_t column) const {
+    return impl->column(column).bools.data();
+}
+
+const char* Cursor::chars(size_t column) const {
+    return impl->column(column).chars.data();
+}
+
+size_t Cursor::charsWidth(size_t column) const {
+    return impl->columns.at(column).charsLength;
+}
+
+// STATEMENT
+
+struct Statement::Impl {
+    std::shared_ptr<node> ast;
+    unsigned long catalogVersion = 0; // the database's catalogVersion when last validated
+    Parameters parameters;
+    std::unique_ptr<Plan> plan; // refers to parameters, so declared after it
+    std::weak_ptr<Stream> streaming; // the plan, while a cursor is still reading its rows
+
+    ~Impl() {
+        drain(streaming);
+    }
+
+    // validate against tables and compile, keeping whatever values are still valid for the new placeholders
+    void compileFor(const std::vector<TableInfo>& tables) {
+        Validator v(tables);
+        v.validate(ast);
+
+        plan.reset();
+        Parameters previous = parameters;
+        parameters = v.getParameters();
+        for (const auto& [index, p] : previous.placeholders) {
+            if (!p.bound)
+                continue;
+            try {
+                parameters.bind(index, p.boundType, p.value);
+            }
+            catch (const QueryError&) {} // left unbound, execution will say so
+        }
+
+        plan = compile(ast->components[0], parameters);
+    }
+
+    Status bind(int index, element_type type, const std::string& value) {
+        if (!ast)
+            return Status::error("Statement has not been prepared.");
+        // the plan's program can't change under a running scan
+        drain(streaming);
+        try {
+            parameters.bind(index, type, value);
+        }
+        catch (const std::exception& e) {
+            return toStatus(e);
+        }
+        return Status::success();
+    }
+};
+
+Statement::Statement() : impl(std::make_unique<Impl>()) {}
+Statement::~Statement() = default;
+Statement::Statement(Statement&&) = default;
+Statement& Statement::operator=(Statement&&) = default;
+
+Status Statement::bind(int index, int value) {
+    return impl->bind(index, int_literal, std::to_string(value));
+}
+
+Status Statement::bind(int index, float value) {
+    // shortest text that reads back as the same float
+    char buffer[32];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    return impl->bind(index, float_literal, std::string(buffer, result.ptr));
+}
+
+Status Statement::bind(int index, bool value) {
+    return impl->bind(index, bool_literal, value ? "true" : "false");
+}
+
+Status Statement::bind(int index, const std::string& value) {
+    return impl->bind(index, chars_literal, value);
+}
+
+Status Statement::bind(int index, const char* value) {
+    return impl->bind(index, chars_literal, value);
+}
+
+Status Statement::bindNull(int index) {
+    return impl->bind(index, kw_null, "");
+}
+
+size_t Statement::parameterCount() const {
+    return impl->parameters.placeholders.size();
+}
+
+std::string Statement::filterOrder() const {
+    // the order can change until a running scan is done
+    drain(impl->streaming);
+    return impl->plan ? impl->plan->filterOrder() : "";
+}
+
+std::string Statement::joinStatistics() const {
+    drain(impl->streaming);
+    return impl->plan ? impl->plan->joinStatistics() : "";
+}
+
+std::string Statement::sortStatistics() const {
+    drain(impl->streaming);
+    return impl->plan ? impl->plan->sortStatistics() : "";
+}
+
+// DATABASE
+
+struct Database::Impl {
+    std::string directory;
+    std::vector<TableInfo> tables;
+    unsigned long catalogVersion = 0; // bumped whenever a table is defined or dropped
+    std::weak_ptr<Stream> streaming;  // the last statement executed into a cursor, while its rows are still being read
+    std::string outputFormat = "pretty";
+    size_t joinMemoryBudget = JOIN_MEMORY_BUDGET;
+    unsigned int joinThreads = JOIN_THREADS;
+    size_t sortMemoryBudget = SORT_MEMORY_BUDGET;
+
+    // get a statement ready to run against the current tables
+    void ready(Statement::Impl& statement) {
+        TABLE_DIRECTORY = directory;
+        JOIN_MEMORY_BUDGET = joinMemoryBudget;
+        JOIN_THREADS = joinThreads;
+        SORT_MEMORY_BUDGET = sortMemoryBudget;
+
+        // tables were defined or dropped since the statement was compiled, make sure it still makes sense and reopen its tables
+        if (statement.catalogVersion != catalogVersion || !statement.plan) {
+            statement.compileFor(tables);
+            statement.catalogVersion = catalogVersion;
+        }
+
+        statement.parameters.requireBound();
+    }
+
+    // keep track of what a statement changed
+    void ran(std::shared_ptr<node> statementRoot) {
+        if (statementRoot->type == definition || statementRoot->type == drop) {
+            tables = buildTableList(directory);
+            ++catalogVersion;
+        }
+        if (statementRoot->type == output)
+            outputFormat = statementRoot->components[0]->value;
+    }
+};
+
+Database::Database() : impl(std::make_unique<Impl>()) {}
+Database::~Database() = default;
+
+Status Database::open(const std::string& directory, std::unique_ptr<Database>& database) {
+    if (!std::filesystem::is_directory(directory))
+        return Status::error("\"" + directory + "\" is not a directory.");
+
+    std::unique_ptr<Database> opened(new Database());
+    opened->impl->directory = directory;
+    if (opened->impl->directory.back() != '/')
+        opened->impl->directory += '/';
+
+    try {
+        opened->impl->tables = buildTableList(opened->impl->directory);
+    }
+    catch (const std::exception& e) {
+        return toStatus(e);
+    }
+
+    database = std::move(opened);
+    return Status::success();
+}
+
+Status Database::prepare(const std::string& script, Statement& statement) {
+    drain(impl->streaming);
+    drain(statement.impl->streaming);
+
+    try {
+        std::string text = script;
+        remove_comments(text);
+        Parser p(tokenize(text));
+        std::shared_ptr<node> ast = p.parse();
+
+        if (ast->components.size() != 1)
+            return Status::error("prepare() takes exactly one statement, but the script has " + std::to_string(ast->components.size()) + ".");
+
+        TABLE_DIRECTORY = impl->directory;
+
+        // replaces any earlier statement, values included
+        statement.impl->plan.reset();
+        statement.impl->parameters = Parameters();
+        statement.impl->ast = ast;
+        statement.impl->compileFor(impl->tables);
+        statement.impl->catalogVersion = impl->catalogVersion;
+    }
+    catch (const std::exception& e) {
+        statement.impl->ast = nullptr;
+        return toStatus(e);
+    }
+    return Status::success();
+}
+
+Status Database::execute(Statement& statement, Cursor& cursor) {
+    if (!statement.impl->ast)
+        return Status::error("Statement has not been prepared.");
+
+    drain(impl->streaming);
+    cursor.impl->clear();
+
+    try {
+        impl->ready(*statement.impl);
+        std::shared_ptr<node> statementRoot = statement.impl->ast->components[0];
+
+        // rows are produced on another thread while the cursor reads them
+        if (statementRoot->type == selection || statementRoot->type == join || statementRoot->type == bag_op) {
+            auto stream = std::make_shared<Stream>(*statement.impl->plan);
+            // wait for the columns, so that anything failing before the first row is reported here
+            if (!stream->queue.waitForBegin()) {
+                stream->drain();
+                stream->rethrowIfFailed();
+            }
+            cursor.impl->start(stream);
+            impl->streaming = stream;
+            statement.impl->streaming = stream;
+        }
+        // the rest produce no rows
+        else {
+            BatchQueue none;
+            Batcher batcher(none);
+            statement.impl->plan->run(batcher);
+        }
+
+        impl->ran(statementRoot);
+    }
+    catch (const std::exception& e) {
+        cursor.impl->clear();
+        return toStatus(e);
+    }
+    return Status::success();
+}
+
+Status Database::execute(Statement& statement) {
+    Cursor discarded;
+    return execute(statement, discarded);
+}
+
+Status Database::execute(Statement& statement, std::ostream& out) {
+    if (!statement.impl->ast)
+        return Status::error("Statement has not been prepared.");
+
+    drain(impl->streaming);
+
+    try {
+        impl->ready(*statement.impl);
+
+        FormattedOutput output(out, impl->outputFormat);
+        Batcher batcher(output);
+        statement.impl->plan->run(batcher);
+
+        impl->ran(statement.impl->ast->components[0]);
+    }
+    catch (const std::exception& e) {
+        return toStatus(e);
+    }
+    return Status::success();
+}
+
+void Database::setOutputFormat(OutputFormat format) {
+    switch (format) {
+        case OutputFormat::Pretty: impl->outputFormat = "pretty"; break;
+        case OutputFormat::Csv: impl->outputFormat = "csv"; break;
+        case OutputFormat::Tsv: impl->outputFormat = "tsv"; break;
+        case OutputFormat::Binary: impl->outputFormat = "binary"; break;
+    }
+}
+
+void Database::setJoinMemoryBudget(size_t bytes) {
+    impl->joinMemoryBudget = bytes;
+}
+
+void Database::setJoinThreads(unsigned int threads) {
+    impl->joinThreads = std::max(1u, threads);
+}
+
+void Database::setSortMemoryBudget(size_t bytes) {
+    impl->sortMemoryBudget = bytes;
+}
+
+}
@@ -0,0 +1,186 @@
+// femtoql.hpp
+
+// public interface of libfemtoql, for running scripts from inside another program
+// nothing here depends on the engine's own headers, so this is the only file an application needs to include
+//
+//     std::unique_ptr<femtoql::Database> db;
+//     femtoql::Status status = femtoql::Database::open("tables/", db);
+//
+//     femtoql::Statement statement;
+//     status = db->prepare("select from t: id, name where id > ?1", statement);
+//
+//     femtoql::Cursor cursor;
+//     status = statement.bind(1, 5);
+//     status = db->execute(statement, cursor);
+//     while (cursor.next())
+//         use(cursor.getInt(0), cursor.getChars(1));
+//
+// errors never print or exit, they come back as a Status
+// a Database is not thread safe, and the table directory is process-wide state, so only use one Database at a time
+// rows are produced on a background thread as they are read, so link with -pthread
+
+#ifndef FEMTOQL
+#define FEMTOQL
+
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <iosfwd>
+
+namespace femtoql {
+
+struct Status {
+    bool ok = true;
+    std::string message; // empty when ok
+
+    static Status success() {
+        return Status();
+    }
+
+    static Status error(const std::string& message) {
+        Status status;
+        status.ok = false;
+        status.message = message;
+        return status;
+    }
+};
+
+enum class ColumnType { Int, Float, Chars, Bool };
+
+// how execute(statement, out) writes rows
+// Pretty is the command line's aligned table, Csv and Tsv have a header line of column names,
+// and Binary writes the column vectors themselves (see BinaryWriter in Output.hpp for the layout)
+enum class OutputFormat { Pretty, Csv, Tsv, Binary };
+
+// rows produced by executing a selection, join, or bag operation
+// column indexes are in the order the statement produces them
+//
+// rows arrive in batches of up to 1024, stored column by column. the statement keeps running in the background
+// only a few batches ahead of the reader, and stops early if the cursor is destroyed or reused.
+// running anything else on the database first lets the statement finish, keeping the rest of its rows in memory
+class Cursor {
+public:
+    Cursor();
+    ~Cursor();
+    Cursor(Cursor&&);
+    Cursor& operator=(Cursor&&);
+
+    // advance to the next row, moving on to the next batch when needed. false once there are no more
+    bool next();
+
+    // advance to the next whole batch, skipping what's left of the current one. false once there are no more
+    // next() then moves through the rows of the new batch from its first row
+    bool nextBatch();
+    size_t batchSize() const;
+
+    // an error from the statement after it started producing rows, checked once next() or nextBatch() returns false
+    Status status() const;
+
+    size_t columnCount() const;
+    const std::string& columnName(size_t column) const;
+    ColumnType columnType(size_t column) const;
+
+    // getters for the current row
+    bool isNull(size_t column) const;
+    int getInt(size_t column) const;
+    float getFloat(size_t column) const;
+    std::string getChars(size_t column) const;
+    bool getBool(size_t column) const;
+
+    // the current batch's values for a column, batchSize() of each
+    // only the one matching the column's type is valid. a null row has nulls()[row] == 1 and a zeroed value
+    const uint8_t* nulls(size_t column) const;
+    const int* ints(size_t column) const;
+    const float* floats(size_t column) const;
+    const uint8_t* bools(size_t column) const;
+    const char* chars(size_t column) const; // charsWidth() bytes per row, padded with '\0'
+    size_t charsWidth(size_t column) const;
+
+    struct Impl;
+private:
+    std::unique_ptr<Impl> impl;
+    friend class Database;
+};
+
+// a single tokenized, parsed, validated, and compiled statement, ready to be executed any number of times
+// its tables stay open and its where clause stays converted between executions, so executing again only costs the scan
+class Statement {
+public:
+    Statement();
+    ~Statement();
+    Statement(Statement&&);
+    Statement& operator=(Statement&&);
+
+    // bind a value to the placeholder ?index. values are kept between executions
+    // a placeholder takes the type of the column it is compared to or written into, and only written ones can be null
+    Status bind(int index, int value);
+    Status bind(int index, float value);
+    Status bind(int index, bool value);
+    Status bind(int index, const std::string& value);
+    Status bind(int index, const char* value);
+    Status bindNull(int index);
+
+    // number of distinct placeholders in the statement
+    size_t parameterCount() const;
+
+    // the where clause in the order its terms were last evaluated in, with what was sampled for each, for diagnostics, e.g.
+    //     id > 10 [pass 99.0%, 1.2 ns/row] && name in t.name [pass 4.1%, 21.5 ns/row]
+    // terms of && and || are reordered while scanning, so this can differ from the script. empty without a where clause
+    std::string filterOrder() const;
+
+    // how much the last execution's join spilled to disk, and how many rows it read back from a table by position, e.g.
+    //     spilled 1200000 rows, 20.6 MiB, to 15 partitions in 1 level, read 250000 rows back late
+    // empty when it did neither, or isn't a join or a define from one
+    std::string joinStatistics() const;
+
+    // how much the last execution's order clause spilled to disk, in how many sorted runs, and how many passes merged them, e.g.
+    //     spilled 1200000 rows, 20.6 MiB, in 12 sorted runs, merged in 1 pass
+    // empty when its rows were sorted in memory, or it has no order clause
+    std::string sortStatistics() const;
+
+    struct Impl;
+private:
+    std::unique_ptr<Impl> impl;
+    friend class Database;
+};
+
+class Database {
+public:
+    ~Database();
+
+    // open the directory holding the .ftbl files
+    static Status open(const std::string& directory, std::unique_ptr<Database>& database);
+
+    // prepare a script containing exactly one statement
+    Status prepare(const std::string& script, Statement& statement);
+
+    // execute a prepared statement, leaving its rows in cursor
+    Status execute(Statement& statement, Cursor& cursor);
+
+    // execute a prepared statement, discarding any rows
+    Status execute(Statement& statement);
+
+    // execute a prepared statement, writing any rows to out in the session's output format
+    Status execute(Statement& statement, std::ostream& out);
+
+    // the session's output format, Pretty until changed here or by an output statement
+    void setOutputFormat(OutputFormat format);
+
+    // bytes an == join may hash in memory, 1 GiB until changed. past it, both tables are partitioned to temporary files and joined a partition at a time
+    void setJoinMemoryBudget(size_t bytes);
+
+    // threads a join may build its hash table and look up rows on, every core until changed. rows come out in the same order either way
+    void setJoinThreads(unsigned int threads);
+
+    // bytes an order clause may sort in memory, 1 GiB until changed. past it, rows are sorted in runs spilled to temporary files and merged
+    void setSortMemoryBudget(size_t bytes);
+
+    struct Impl;
+private:
+    Database();
+    std::unique_ptr<Impl> impl;
+};
+
+}
+
+#endif
@@ -26,6 +26,10 @@ void traverse(const std::shared_ptr<node>& current_node, std::ofstream& out) {
         if (current_node->type == chars_literal) {
             out << "\\\"" << current_node->value << "\\\"";
         }
+        // for parameters, add ?
+        else if (current_node->type == parameter) {
+            out << '?' << current_node->value;
+        }
         else
             out << current_node->value;
     }
@@ -19,6 +19,51 @@ struct node {
     node(element_type type, std::vector<std::shared_ptr<node>> vec) : type(type), components(vec) {}; // for non-terminals
 };
 
+// a join node is the joined tables' identifiers, then one or more on_exprs, then an alias_list or nullnode, then a where_clause or nullnode,
+// then a column_list or nullnode
+
+// the names of the joined tables, in the order the join names them
+std::vector<std::string> joinTableNames(const std::shared_ptr<node>& joinRoot) {
+    std::vector<std::string> names;
+    for (auto& component : joinRoot->components)
+        if (component->type == identifier)
+            names.push_back(component->value);
+    return names;
+}
+
+// the on_exprs of a join
+std::vector<std::shared_ptr<node>> joinConditions(const std::shared_ptr<node>& joinRoot) {
+    std::vector<std::shared_ptr<node>> conditions;
+    for (auto& component : joinRoot->components)
+        if (component->type == on_expr)
+            conditions.push_back(component);
+    return conditions;
+}
+
+// the alias_list of a join, or a nullnode without one
+std::shared_ptr<node> joinAliasList(const std::shared_ptr<node>& joinRoot) {
+    for (auto& component : joinRoot->components)
+        if (component->type == alias_list || component->type == nullnode)
+            return component;
+    return std::make_shared<node>(nullnode);
+}
+
+// the where_clause of a join, or a nullnode without one
+std::shared_ptr<node> joinWhereClause(const std::shared_ptr<node>& joinRoot) {
+    for (auto& component : joinRoot->components)
+        if (component->type == where_clause)
+            return component;
+    return std::make_shared<node>(nullnode);
+}
+
+// the column_list a join selects, or a nullnode when it keeps every column
+std::shared_ptr<node> joinColumnList(const std::shared_ptr<node>& joinRoot) {
+    for (auto& component : joinRoot->components)
+        if (component->type == column_list)
+            return component;
+    return std::make_shared<node>(nullnode);
+}
+
 void post_order_traversal(std::shared_ptr<node> root) {
     if (root == nullptr) return;
 
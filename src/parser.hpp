@@ -7,6 +7,7 @@
 #include <memory>
 #include "token.hpp"
 #include "node.hpp"
+#include "QueryError.hpp"
 
 class Parser {
 private:
@@ -18,7 +19,7 @@ public:
     Parser(std::vector<token> token_stream) 
         : tokens(token_stream), it(tokens.begin()) {};
 
-    // script -> [definition|selection|join|bag_op|drop|insertion|update|deletion]*
+    // script -> [definition|selection|join|bag_op|drop|insertion|update|deletion|output]*
     std::shared_ptr<node> parse() {
         current_non_terminal = script;
 
@@ -40,10 +41,11 @@ public:
                 script_components.push_back(parse_deletion());
             else if (it->type == kw_drop)
                 script_components.push_back(parse_drop());
+            else if (it->type == kw_output)
+                script_components.push_back(parse_output());
             else {
-                std::cout << "Parser error on line " << it->line_number 
-                          << ". Unexpected " << tokenTypeToString(it->type) << " at start/end of statement.\n";
-                exit(1);
+                throw QueryError() << "Parser error on line " << it->line_number 
+                                   << ". Unexpected " << tokenTypeToString(it->type) << " at start/end of statement.\n";
             }
         }
         return std::make_shared<node>(script, script_components);
@@ -75,9 +77,8 @@ public:
         else if (it->type == kw_union || it->type == kw_intersect)
             dfn_components.push_back(parse_bag_op());
         else {
-            std::cout << "Parser error on line " << it->line_number 
-                      << ". Expected a selection, join, or bag operation after as in definition.\n";
-            exit(1);
+            throw QueryError() << "Parser error on line " << it->line_number 
+                               << ". Expected a selection, join, or bag operation after as in definition.\n";
         }
 
         return std::make_shared<node>(definition, dfn_components);
@@ -115,7 +116,7 @@ public:
         std::vector<std::shared_ptr<node>> cl_components;
         // identifier list path
         if (it->type == identifier) {
-            while (it->type == identifier && (it + 1)->type == comma) {
+            while (it->type == identifier && it + 1 != tokens.end() && (it + 1)->type == comma) {
                 consume(identifier, cl_components);
                 discard(comma);
             }
@@ -125,11 +126,10 @@ public:
         else if (it->type == asterisk)
             consume(asterisk, cl_components);
         else {
-            std::cout << "Parser error on line " << it->line_number 
-                      << ". Expected a column list or * after "
-                      << tokenTypeToString((it-1)->type)
-                      << " in select clause.\n";
-            exit(1);
+            throw QueryError() << "Parser error on line " << it->line_number 
+                               << ". Expected a column list or * after "
+                               << tokenTypeToString((it-1)->type)
+                               << " in select clause.\n";
         }
 
         return std::make_shared<node>(column_list, cl_components);
@@ -202,16 +202,15 @@ public:
                 // @NOTE peeking back on this check
                 if ((it-1)->type != op_equals && (it-1)->type != op_not_equals) {
                     if (it->type >= kw_null && it->type <= kw_false ) {
-                        std::cout << "Parser error on line " << it->line_number 
-                                  << ". You tried to compare >, <, <=, or >= on "
-                                  << tokenTypeToString(it->type)
-                                  << " in boolean expression.\n";
-                        exit(1);
+                        throw QueryError() << "Parser error on line " << it->line_number 
+                                           << ". You tried to compare >, <, <=, or >= on "
+                                           << tokenTypeToString(it->type)
+                                           << " in boolean expression.\n";
                     }
                 } 
 
-                // identifier or literal (incl. null)
-                if (it->type >= identifier && it->type <= kw_null) {
+                // identifier, literal (incl. null), or parameter
+                if ((it->type >= identifier && it->type <= kw_null) || it->type == parameter) {
                     // @TODO: unexpected end of input here still results in issue #6
                     consume(it->type, lhs_components);
                 }
@@ -232,33 +231,30 @@ public:
                     consume(identifier, lhs_components);
                 }
                 else {
-                    std::cout << "Parser error on line " << it->line_number 
-                              << ". Expected a keyword any/all/null or a(n) int/float/chars/bool literal after "
-                              << tokenTypeToString((it-1)->type)
-                              << " in boolean expression.\n";
-                    exit(1);
+                    throw QueryError() << "Parser error on line " << it->line_number 
+                                       << ". Expected a keyword any/all/null or a(n) int/float/chars/bool literal after "
+                                       << tokenTypeToString((it-1)->type)
+                                       << " in boolean expression.\n";
                 }
             }
             else {
-                std::cout << "Parser error on line " << it->line_number 
-                          << ". Expected a keyword in or a comparison after "
-                          << tokenTypeToString((it-1)->type)
-                          << " in boolean expression.\n";
-                exit(1);
+                throw QueryError() << "Parser error on line " << it->line_number 
+                                   << ". Expected a keyword in or a comparison after "
+                                   << tokenTypeToString((it-1)->type)
+                                   << " in boolean expression.\n";
             }
 
             potential_lhs = std::make_shared<node>(bool_expr, lhs_components);
         }
         else {
-            std::cout << "Parser error on line " << it->line_number 
-                      << ". Expected !, (, or an identifier after "
-                      << tokenTypeToString((it-1)->type)
-                      << " in boolean expression.\n";
-            exit(1);
+            throw QueryError() << "Parser error on line " << it->line_number 
+                               << ". Expected !, (, or an identifier after "
+                               << tokenTypeToString((it-1)->type)
+                               << " in boolean expression.\n";
         }
 
         // && or ||
-        if (it->type == op_and || it->type == op_or) {
+        if (it != tokens.end() && (it->type == op_and || it->type == op_or)) {
 
             std::vector<std::shared_ptr<node>> be_components;
             be_components.push_back(potential_lhs); // push left hand side
@@ -282,11 +278,10 @@ public:
         consume(identifier, oc_components);
 
         if (it->type != kw_asc && it->type != kw_desc)  {
-            std::cout << "Parser error on line " << it->line_number 
-                      << ". Expected a column list or * after "
-                      << tokenTypeToString((it-1)->type)
-                      << " in order clause.\n";
-            exit(1);
+            throw QueryError() << "Parser error on line " << it->line_number 
+                               << ". Expected a column list or * after "
+                               << tokenTypeToString((it-1)->type)
+                               << " in order clause.\n";
         }
         oc_components.push_back(std::make_shared<node>(it->type));
         it++; // consume kw_asc/desc
@@ -294,7 +289,7 @@ public:
         return std::make_shared<node>(order_clause, oc_components);
     }
 
-    // join -> kw_join identifier comma identifier on_expr alias_list|ε
+    // join -> kw_join identifier comma identifier [comma identifier]* on_expr [on_expr]* alias_list|ε where_clause|ε [kw_select column_list]|ε
     std::shared_ptr<node> parse_join() {
         current_non_terminal = join;
 
@@ -303,14 +298,33 @@ public:
         consume(identifier, je_components);
         discard(comma);
         consume(identifier, je_components);
+        while (it != tokens.end() && it->type == comma) {
+            discard(comma);
+            consume(identifier, je_components);
+        }
         discard(colon);
         je_components.push_back(parse_on_expr());
+        while (it != tokens.end() && it->type == kw_on)
+            je_components.push_back(parse_on_expr());
 
-        if (it->type == kw_with)
+        if (it != tokens.end() && it->type == kw_with)
             je_components.push_back(parse_alias_list());
         else
             je_components.push_back(std::make_shared<node>(nullnode));
 
+        if (it != tokens.end() && it->type == kw_where)
+            je_components.push_back(parse_where_clause());
+        else
+            je_components.push_back(std::make_shared<node>(nullnode));
+
+        // a select statement after the join starts select from or select distinct, so select then a column is the join's
+        if (it != tokens.end() && it->type == kw_select && it + 1 != tokens.end() && ((it + 1)->type == identifier || (it + 1)->type == asterisk)) {
+            discard(kw_select);
+            je_components.push_back(parse_column_list());
+        }
+        else
+            je_components.push_back(std::make_shared<node>(nullnode));
+
         return std::make_shared<node>(join, je_components);
     }
 
@@ -327,11 +341,10 @@ public:
             ++it; // consume comparison
         }
         else {
-            std::cout << "Parser error on line " << it->line_number 
-                      << ". Expected a comparison after "
-                      << tokenTypeToString((it-1)->type)
-                      << " in on expression.\n";
-            exit(1);
+            throw QueryError() << "Parser error on line " << it->line_number 
+                               << ". Expected a comparison after "
+                               << tokenTypeToString((it-1)->type)
+                               << " in on expression.\n";
         }
 
         consume(identifier, oe_components);
@@ -380,11 +393,10 @@ public:
             ++it; // consume union/intersect
         }
         else {
-            std::cout << "Parser error on line " << it->line_number 
-                      << ". Expected a union or intersect after "
-                      << tokenTypeToString((it-1)->type)
-                      << " in bag operation.\n";
-            exit(1);
+            throw QueryError() << "Parser error on line " << it->line_number 
+                               << ". Expected a union or intersect after "
+                               << tokenTypeToString((it-1)->type)
+                               << " in bag operation.\n";
         }
         consume(identifier, se_components);
         discard(comma);
@@ -459,8 +471,8 @@ public:
         std::vector<std::shared_ptr<node>> cv_components;
         consume(identifier, cv_components);
         discard(open_parenthesis);
-        // literal (incl. null)
-        if (it->type >= int_literal && it->type <= kw_null)
+        // literal (incl. null) or parameter
+        if ((it->type >= int_literal && it->type <= kw_null) || it->type == parameter)
             // @TODO: unexpected end of input here still results in issue #6
             consume(it->type, cv_components);
         // @NOTE if it's kw_true or kw_false, the type should be bool_literal with value "true" or "false" respectively
@@ -473,11 +485,10 @@ public:
             ++it;
         }
         else {
-            std::cout << "Parser error on line " << it->line_number 
-                      << ". Expected a literal after "
-                      << tokenTypeToString((it-1)->type)
-                      << " in column, value pair.\n";
-            exit(1);
+            throw QueryError() << "Parser error on line " << it->line_number 
+                               << ". Expected a literal after "
+                               << tokenTypeToString((it-1)->type)
+                               << " in column, value pair.\n";
         }
         discard(close_parenthesis);
 
@@ -517,11 +528,10 @@ public:
                 consume(int_literal, ct_components);
         }
         else {
-            std::cout << "Parser error on line " << it->line_number 
-                      << ". Expected a type after "
-                      << tokenTypeToString((it-1)->type)
-                      << " in column, type pair.\n";
-            exit(1);
+            throw QueryError() << "Parser error on line " << it->line_number 
+                               << ". Expected a type after "
+                               << tokenTypeToString((it-1)->type)
+                               << " in column, type pair.\n";
         }
         discard(close_parenthesis);
 
@@ -539,21 +549,30 @@ public:
         return std::make_shared<node>(drop, de_components);
     }
 
+    // output -> kw_output identifier
+    std::shared_ptr<node> parse_output() {
+        current_non_terminal = output;
+
+        std::vector<std::shared_ptr<node>> op_components;
+        discard(kw_output);
+        consume(identifier, op_components);
+
+        return std::make_shared<node>(output, op_components);
+    }
+
     void discard(element_type expected_type) {
 
         if (it == tokens.end()) {
-            std::cout << "Parser error on line " << (it-1)->line_number
-                      << ". Unexpected end of input after " << tokenTypeToString((it-1)->type) 
-                      << " in " <<  tokenTypeToString(current_non_terminal) << ".\n";
-            exit(1);
+            throw QueryError() << "Parser error on line " << (it-1)->line_number
+                               << ". Unexpected end of input after " << tokenTypeToString((it-1)->type) 
+                               << " in " <<  tokenTypeToString(current_non_terminal) << ".\n";
         }
 
         if (it->type != expected_type) {
-            std::cout << "Parser error on line " << it->line_number 
-                      << ". Expected a(n) " << tokenTypeToString(expected_type) 
-                      << " after " << tokenTypeToString((it-1)->type)
-                      << " in " << tokenTypeToString(current_non_terminal) << ".\n";
-            exit(1);
+            throw QueryError() << "Parser error on line " << it->line_number 
+                               << ". Expected a(n) " << tokenTypeToString(expected_type) 
+                               << " after " << tokenTypeToString((it-1)->type)
+                               << " in " << tokenTypeToString(current_non_terminal) << ".\n";
         }
         ++it; // consume token
     }
@@ -561,22 +580,20 @@ public:
     void consume(element_type expected_type, std::vector<std::shared_ptr<node>>& components) {
 
         if (it == tokens.end()) {
-            std::cout << "Parser error on line " << (it-1)->line_number
-                      << ". Unexpected end of input after " << tokenTypeToString((it-1)->type) 
-                      << " in " << tokenTypeToString(current_non_terminal) << ".\n";
-            exit(1);
+            throw QueryError() << "Parser error on line " << (it-1)->line_number
+                               << ". Unexpected end of input after " << tokenTypeToString((it-1)->type) 
+                               << " in " << tokenTypeToString(current_non_terminal) << ".\n";
         }
 
         if (it->type != expected_type) {
-            std::cout << "Parser error on line " << it->line_number 
-                      << ". Expected a(n) " << tokenTypeToString(expected_type) 
-                      << " after " << tokenTypeToString((it-1)->type)
-                      << " in " << tokenTypeToString(current_non_terminal) << ".\n";
-            exit(1);
+            throw QueryError() << "Parser error on line " << it->line_number 
+                               << ". Expected a(n) " << tokenTypeToString(expected_type) 
+                               << " after " << tokenTypeToString((it-1)->type)
+                               << " in " << tokenTypeToString(current_non_terminal) << ".\n";
         }
 
-        // use constructor with value for identifiers and literals
-        if (it->type >= identifier && it->type <= float_literal) {
+        // use constructor with value for identifiers, literals, and parameters
+        if ((it->type >= identifier && it->type <= float_literal) || it->type == parameter) {
             components.push_back(std::make_shared<node>(it->type, it->value));
             ++it; // consume token
             return;
@@ -589,10 +606,9 @@ public:
     void consume_optional(element_type expected_type, std::vector<std::shared_ptr<node>>& components) {
 
         if (it == tokens.end()) {
-            std::cout << "Parser error on line " << (it-1)->line_number
-                      << ". Unexpected end of input after " << tokenTypeToString((it-1)->type) 
-                      << " in " << current_non_terminal << ".\n";
-            exit(1);
+            throw QueryError() << "Parser error on line " << (it-1)->line_number
+                               << ". Unexpected end of input after " << tokenTypeToString((it-1)->type) 
+                               << " in " << current_non_terminal << ".\n";
         }
 
         if (it->type == expected_type) {
@@ -0,0 +1,534 @@
+// simplify.hpp
+
+#ifndef SIMPLIFY
+#define SIMPLIFY
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <optional>
+#include <climits>
+#include <algorithm>
+#include <iterator>
+#include "node.hpp"
+#include "TableInfo.hpp"
+
+// rewrites a validated where clause into an equivalent one that's cheaper to evaluate, before it's compiled:
+//     parentheses are dropped and each ! is pushed down through && and || until it sits on a single comparison
+//     comparisons of the same column to literals in one && or || group are merged, e.g. a > 1 && a >= 3 && !(a >= 10) is a >= 3 && a < 10
+//     repeated terms are dropped, and a group that can't be true, or can't be false, e.g. a < 5 && a > 10, becomes false or true
+// a comparison is false when either side is null, so !(a < 5) passes a null a where a >= 5 doesn't,
+// and a float can be NaN, which fails every comparison but !=. a ! is only turned into the opposite comparison where that doesn't matter
+
+// a where clause as simplify() reads it
+struct Condition {
+    enum Kind { False, True, Leaf, And, Or } kind = True;
+    std::shared_ptr<node> comparison;   // Leaf: a bool_expr without && or ||, as the parser builds it
+    bool negated = false;               // Leaf: !(comparison)
+    std::vector<Condition> children;    // And, Or: two or more
+};
+
+Condition constant(bool value) {
+    Condition c;
+    c.kind = value ? Condition::True : Condition::False;
+    return c;
+}
+
+// !(c == null) is c != null, and the other way around
+Condition leaf(std::shared_ptr<node> comparison, bool negated) {
+    Condition c;
+    c.kind = Condition::Leaf;
+    if (negated && comparison->components[2]->type == kw_null) {
+        element_type op = comparison->components[1]->type == op_equals ? op_not_equals : op_equals;
+        comparison = std::make_shared<node>(bool_expr, std::vector<std::shared_ptr<node>>{
+            comparison->components[0], std::make_shared<node>(op), comparison->components[2]});
+        negated = false;
+    }
+    c.comparison = comparison;
+    c.negated = negated;
+    return c;
+}
+
+Condition leaf(const std::string& column, element_type op, element_type rhsType, const std::string& rhs, bool negated) {
+    auto comparison = std::make_shared<node>(bool_expr, std::vector<std::shared_ptr<node>>{
+        std::make_shared<node>(identifier, column), std::make_shared<node>(op), std::make_shared<node>(rhsType, rhs)});
+    return leaf(comparison, negated);
+}
+
+// by De Morgan's laws. there's no third truth value, a comparison with a null is just false, so they always hold
+Condition negate(Condition c) {
+    switch (c.kind) {
+        case Condition::False:
+        case Condition::True:
+            return constant(c.kind == Condition::False);
+        case Condition::Leaf:
+            return leaf(c.comparison, !c.negated);
+        case Condition::And:
+        case Condition::Or:
+            c.kind = c.kind == Condition::And ? Condition::Or : Condition::And;
+            for (Condition& child : c.children)
+                child = negate(child);
+            return c;
+    }
+    return c;
+}
+
+// as written in a where clause, to find repeated terms by
+std::string conditionText(const Condition& c) {
+    switch (c.kind) {
+        case Condition::False:
+            return "false";
+        case Condition::True:
+            return "true";
+        case Condition::Leaf: {
+            std::string text;
+            for (auto& component : c.comparison->components) {
+                if (!text.empty())
+                    text += ' ';
+                if (component->type == chars_literal)
+                    text += '"' + component->value + '"';
+                else if (component->type == parameter)
+                    text += '?' + component->value;
+                else if (!component->value.empty())
+                    text += component->value;
+                else
+                    text += tokenTypeToString(component->type);
+            }
+            return c.negated ? "!(" + text + ")" : text;
+        }
+        case Condition::And:
+        case Condition::Or: {
+            std::string text = "(";
+            for (size_t k = 0; k < c.children.size(); ++k)
+                text += (k == 0 ? "" : c.kind == Condition::And ? " && " : " || ") + conditionText(c.children[k]);
+            return text + ")";
+        }
+    }
+    return "";
+}
+
+// column op column with the same column on both sides
+// it's null or it isn't, except that a NaN float isn't equal to itself, so floats are left alone
+std::optional<Condition> selfComparison(const ColumnInfo& column, element_type op) {
+    if (op == op_less_than || op == op_greater_than)
+        return constant(false);
+    if (column.type == float_literal)
+        return std::nullopt;
+    if (op == op_not_equals)
+        return constant(false);
+    return leaf(column.name, op_not_equals, kw_null, "", false);
+}
+
+// parentheses dropped, every ! pushed down onto a comparison, and chains of && or || flattened into one group
+Condition buildCondition(std::shared_ptr<node> boolExprRoot, bool negated, const TableInfo& t) {
+
+    // (bool_expr)
+    if (boolExprRoot->components.size() == 1)
+        return buildCondition(boolExprRoot->components[0], negated, t);
+
+    // !(bool_expr)
+    if (boolExprRoot->components[0]->type == op_not)
+        return buildCondition(boolExprRoot->components[1], !negated, t);
+
+    // bool_expr op_and bool_expr, bool_expr op_or bool_expr
+    element_type boolOp = boolExprRoot->components[1]->type;
+    if (boolOp == op_and || boolOp == op_or) {
+        Condition group;
+        group.kind = (boolOp == op_and) != negated ? Condition::And : Condition::Or;
+        for (int side : {0, 2}) {
+            Condition child = buildCondition(boolExprRoot->components[side], negated, t);
+            if (child.kind == group.kind)
+                std::move(child.children.begin(), child.children.end(), std::back_inserter(group.children));
+            else
+                group.children.push_back(std::move(child));
+        }
+        return group;
+    }
+
+    // identifier comparison identifier, both the same column
+    if (boolExprRoot->components[1]->type != kw_in && boolExprRoot->components[2]->type == identifier
+        && boolExprRoot->components[0]->value == boolExprRoot->components[2]->value) {
+        auto same = selfComparison(*find(boolExprRoot->components[0]->value, t.columns), boolExprRoot->components[1]->type);
+        if (same)
+            return negated ? negate(*same) : *same;
+    }
+
+    return leaf(boolExprRoot, negated);
+}
+
+// the values of one column that pass an && group of its comparisons to literals
+// T is long long for int and bool columns, float, or std::string for chars
+template<typename T>
+struct Range {
+    struct Bound {
+        T value;
+        std::string text;   // as it's written in the where clause
+        bool open;          // < or >, rather than <= or >=
+    };
+    std::optional<Bound> lo;
+    std::optional<Bound> hi;
+    std::map<T, std::string> excluded;  // values ruled out by !=
+    bool valuesPass = true;             // false once some value has to be null
+    bool nullPasses = true;
+    bool nanPasses = true;
+
+    void lower(const T& value, const std::string& text, bool open) {
+        if (!lo || value > lo->value || (value == lo->value && open))
+            lo = Bound{value, text, open};
+    }
+
+    void upper(const T& value, const std::string& text, bool open) {
+        if (!hi || value < hi->value || (value == hi->value && open))
+            hi = Bound{value, text, open};
+    }
+
+    // column op value, or !(column op value)
+    // !(column op value) is column op' value for the opposite op', or a null, or a NaN unless op is !=
+    void add(element_type op, bool negated, const T& value, const std::string& text) {
+        if (negated) {
+            nanPasses = nanPasses && op != op_not_equals;
+            op = opposite(op);
+        }
+        else {
+            nullPasses = false;
+            nanPasses = nanPasses && op == op_not_equals;
+        }
+
+        switch (op) {
+            case op_equals:
+                lower(value, text, false);
+                upper(value, text, false);
+                break;
+            case op_not_equals:
+                excluded.emplace(value, text);
+                break;
+            case op_less_than:
+                upper(value, text, true);
+                break;
+            case op_less_than_equals:
+                upper(value, text, false);
+                break;
+            case op_greater_than:
+                lower(value, text, true);
+                break;
+            case op_greater_than_equals:
+                lower(value, text, false);
+                break;
+        }
+    }
+
+    // column == null, column != null
+    void addNull(element_type op) {
+        if (op == op_equals)
+            valuesPass = false;
+        else
+            nullPasses = false;
+    }
+
+    static element_type opposite(element_type op) {
+        switch (op) {
+            case op_equals: return op_not_equals;
+            case op_not_equals: return op_equals;
+            case op_less_than: return op_greater_than_equals;
+            case op_less_than_equals: return op_greater_than;
+            case op_greater_than: return op_less_than_equals;
+            default: return op_less_than;
+        }
+    }
+
+    bool contains(const T& value) const {
+        return (!lo || value > lo->value || (value == lo->value && !lo->open)) && (!hi || value < hi->value || (value == hi->value && !hi->open));
+    }
+
+    bool intervalEmpty() const {
+        return lo && hi && (lo->value > hi->value || (lo->value == hi->value && (lo->open || hi->open)));
+    }
+
+    // bounds closed over the column's values, min and max, so an empty range shows up and bool != becomes ==
+    void normalize(long long min, long long max, bool isBool) {
+        auto text = [isBool](long long value) {
+            return isBool ? std::string(value ? "true" : "false") : std::to_string(value);
+        };
+        long long first = lo ? lo->value + lo->open : min;
+        long long last = hi ? hi->value - hi->open : max;
+        first = std::max(first, min);
+        last = std::min(last, max);
+        while (first <= last && excluded.count(first))
+            ++first;
+        while (first <= last && excluded.count(last))
+            --last;
+
+        if (first > last) {
+            valuesPass = false;
+            return;
+        }
+        lo = first == min ? std::nullopt : std::optional<Bound>(Bound{first, lo && lo->value == first ? lo->text : text(first), false});
+        hi = last == max ? std::nullopt : std::optional<Bound>(Bound{last, hi && hi->value == last ? hi->text : text(last), false});
+        if (isBool && first == last)
+            lo = hi = Bound{first, text(first), false};
+        dropOutside();
+    }
+
+    // excluded values outside the bounds don't need a != of their own
+    void normalize() {
+        if (lo && !lo->open && excluded.count(lo->value))
+            lo->open = true;
+        if (hi && !hi->open && excluded.count(hi->value))
+            hi->open = true;
+        if (intervalEmpty())
+            valuesPass = false;
+        dropOutside();
+    }
+
+    void dropOutside() {
+        for (auto it = excluded.begin(); it != excluded.end();)
+            it = contains(it->first) && !(lo && hi && lo->value == hi->value) ? std::next(it) : excluded.erase(it);
+    }
+};
+
+template<typename T>
+T literalValue(const std::string& text, element_type type) {
+    if constexpr (std::is_same_v<T, long long>)
+        return type == bool_literal ? text == "true" : std::stoll(text);
+    else if constexpr (std::is_same_v<T, float>)
+        return std::stof(text);
+    else
+        return text;
+}
+
+// the comparisons of column to literals in leaves, all of which have to pass, merged into as few as can say the same thing
+// nothing if they can't be said with comparisons to the literals alone, e.g. a float that passes if it's NaN and nothing else
+template<typename T>
+std::optional<std::vector<Condition>> mergeRange(const std::vector<Condition>& leaves, const ColumnInfo& column) {
+    Range<T> range;
+    for (const Condition& c : leaves) {
+        auto rhs = c.comparison->components[2];
+        if (rhs->type == kw_null)
+            range.addNull(c.comparison->components[1]->type);
+        else
+            range.add(c.comparison->components[1]->type, c.negated, literalValue<T>(rhs->value, rhs->type), rhs->value);
+    }
+
+    // a NaN isn't in any interval, so whether it passes doesn't depend on the bounds
+    bool isFloat = column.type == float_literal;
+    bool nanPasses = isFloat && range.valuesPass && range.nanPasses;
+    if constexpr (std::is_same_v<T, long long>) {
+        if (range.valuesPass)
+            column.type == bool_literal ? range.normalize(0, 1, true) : range.normalize(INT_MIN, INT_MAX, false);
+    }
+    else if (range.valuesPass)
+        range.normalize();
+
+    const std::string& name = column.name;
+    element_type type = column.type;
+    std::vector<Condition> merged;
+    if (!range.valuesPass) {
+        if (nanPasses)
+            return std::nullopt;
+        merged.push_back(range.nullPasses ? leaf(name, op_equals, kw_null, "", false) : constant(false));
+        return merged;
+    }
+    if (!range.lo && !range.hi && range.excluded.empty()) {
+        if (isFloat && !nanPasses)
+            return std::nullopt;
+        merged.push_back(range.nullPasses ? constant(true) : leaf(name, op_not_equals, kw_null, "", false));
+        return merged;
+    }
+    if (isFloat && (range.nullPasses ? !nanPasses : !nanPasses && !range.lo && !range.hi))
+        return std::nullopt;
+
+    // positive comparisons fail a null or a NaN, negated ones pass both
+    bool negatedForm = range.nullPasses || nanPasses;
+    bool point = range.lo && range.hi && range.lo->value == range.hi->value;
+    if (!negatedForm) {
+        if (point)
+            merged.push_back(leaf(name, op_equals, type, range.lo->text, false));
+        else {
+            if (range.lo)
+                merged.push_back(leaf(name, range.lo->open ? op_greater_than : op_greater_than_equals, type, range.lo->text, false));
+            if (range.hi)
+                merged.push_back(leaf(name, range.hi->open ? op_less_than : op_less_than_equals, type, range.hi->text, false));
+        }
+        for (auto& [value, text] : range.excluded)
+            merged.push_back(leaf(name, op_not_equals, type, text, false));
+        return merged;
+    }
+
+    if (point && !isFloat)
+        merged.push_back(type == bool_literal ? leaf(name, op_equals, type, range.lo->text == "true" ? "false" : "true", true)
+                                              : leaf(name, op_not_equals, type, range.lo->text, true));
+    else {
+        if (range.lo)
+            merged.push_back(leaf(name, range.lo->open ? op_less_than_equals : op_less_than, type, range.lo->text, true));
+        if (range.hi)
+            merged.push_back(leaf(name, range.hi->open ? op_greater_than_equals : op_greater_than, type, range.hi->text, true));
+    }
+    // != fails a null, so where nulls can't pass it says so on its own
+    for (auto& [value, text] : range.excluded)
+        merged.push_back(leaf(name, range.nullPasses ? op_equals : op_not_equals, type, text, range.nullPasses));
+    if (!range.nullPasses && range.excluded.empty())
+        merged.push_back(leaf(name, op_not_equals, kw_null, "", false));
+    return merged;
+}
+
+// comparisons and ! count against a group, so a merge is kept only when it leaves fewer of either
+std::pair<size_t, size_t> conditionWeight(const std::vector<Condition>& leaves) {
+    std::pair<size_t, size_t> w = {0, 0};
+    for (const Condition& c : leaves) {
+        w.first += c.kind == Condition::Leaf;
+        w.second += c.negated;
+    }
+    return w;
+}
+
+// merge the comparisons to literals on each column of an && or || group
+// a || b is !(!a && !b), so an || group merges the negation of its terms and negates the result
+void mergeRanges(std::vector<Condition>& children, bool isAnd, const TableInfo& t) {
+    std::map<std::string, std::vector<size_t>> byColumn;
+    for (size_t k = 0; k < children.size(); ++k) {
+        const Condition& c = children[k];
+        if (c.kind != Condition::Leaf || c.comparison->components.size() != 3)
+            continue;
+        element_type rhsType = c.comparison->components[2]->type;
+        if (rhsType == int_literal || rhsType == float_literal || rhsType == chars_literal || rhsType == bool_literal || rhsType == kw_null)
+            byColumn[c.comparison->components[0]->value].push_back(k);
+    }
+
+    std::set<size_t> removed;
+    for (auto& [name, indexes] : byColumn) {
+        if (indexes.size() < 2)
+            continue;
+        std::vector<Condition> leaves;
+        for (size_t k : indexes)
+            leaves.push_back(isAnd ? children[k] : negate(children[k]));
+
+        const ColumnInfo& column = *find(name, t.columns);
+        std::optional<std::vector<Condition>> merged;
+        switch (column.type) {
+            case int_literal:
+            case bool_literal:
+                merged = mergeRange<long long>(leaves, column);
+                break;
+            case float_literal:
+                merged = mergeRange<float>(leaves, column);
+                break;
+            case chars_literal:
+                merged = mergeRange<std::string>(leaves, column);
+                break;
+        }
+        if (!merged)
+            continue;
+        if (!isAnd)
+            for (Condition& c : *merged)
+                c = negate(c);
+
+        std::vector<Condition> original;
+        for (size_t k : indexes)
+            original.push_back(children[k]);
+        bool isConstant = merged->size() == 1 && (*merged)[0].kind != Condition::Leaf;
+        if (!isConstant && conditionWeight(*merged) >= conditionWeight(original))
+            continue;
+
+        // the merged comparisons take the place of the first one
+        children[indexes[0]] = (*merged)[0];
+        for (size_t k = 1; k < indexes.size(); ++k)
+            removed.insert(indexes[k]);
+        for (size_t k = 1; k < merged->size(); ++k)
+            children.push_back((*merged)[k]);
+    }
+
+    std::vector<Condition> kept;
+    for (size_t k = 0; k < children.size(); ++k)
+        if (!removed.count(k))
+            kept.push_back(std::move(children[k]));
+    children.swap(kept);
+}
+
+// false && a is false, true && a is a, a && a is a, and a && !a is false. the same for || with true and false swapped
+Condition simplify(const Condition& c, const TableInfo& t) {
+    if (c.kind != Condition::And && c.kind != Condition::Or)
+        return c;
+    bool isAnd = c.kind == Condition::And;
+    Condition::Kind absorbing = isAnd ? Condition::False : Condition::True;
+
+    std::vector<Condition> children;
+    for (const Condition& child : c.children) {
+        Condition s = simplify(child, t);
+        if (s.kind == c.kind)
+            std::move(s.children.begin(), s.children.end(), std::back_inserter(children));
+        else
+            children.push_back(std::move(s));
+    }
+
+    for (int pass = 0; pass < 2; ++pass) {
+        std::vector<Condition> kept;
+        std::set<std::string> seen;
+        for (Condition& child : children) {
+            if (child.kind == absorbing)
+                return child;
+            if (child.kind == Condition::True || child.kind == Condition::False)
+                continue;
+            std::string text = conditionText(child);
+            if (seen.count(conditionText(negate(child))))
+                return constant(!isAnd);
+            if (seen.insert(text).second)
+                kept.push_back(std::move(child));
+        }
+        children.swap(kept);
+
+        // merging can leave a constant, or a comparison that's already in the group
+        if (pass == 0)
+            mergeRanges(children, isAnd, t);
+    }
+
+    if (children.empty())
+        return constant(isAnd);
+    if (children.size() == 1)
+        return children[0];
+    Condition group;
+    group.kind = c.kind;
+    group.children = std::move(children);
+    return group;
+}
+
+// back into the parser's shape. a chain of && or || nests to the right, the way it's parsed
+std::shared_ptr<node> toNode(const Condition& c) {
+    switch (c.kind) {
+        case Condition::False:
+            return std::make_shared<node>(kw_false);
+        case Condition::True:
+            return std::make_shared<node>(kw_true);
+        case Condition::Leaf:
+            if (!c.negated)
+                return c.comparison;
+            return std::make_shared<node>(bool_expr, std::vector<std::shared_ptr<node>>{std::make_shared<node>(op_not), c.comparison});
+        default: {
+            element_type boolOp = c.kind == Condition::And ? op_and : op_or;
+            std::shared_ptr<node> chain = toNode(c.children.back());
+            for (size_t k = c.children.size() - 1; k-- > 0;)
+                chain = std::make_shared<node>(bool_expr, std::vector<std::shared_ptr<node>>{toNode(c.children[k]), std::make_shared<node>(boolOp), chain});
+            return chain;
+        }
+    }
+}
+
+// the columns c compares, e.g. to tell which tables of a join it's on. the rhs of an in, any, or all is another table's, so it isn't one
+void conditionColumns(const Condition& c, std::vector<std::string>& columns) {
+    if (c.kind == Condition::Leaf) {
+        auto& comparison = c.comparison->components;
+        columns.push_back(comparison[0]->value);
+        if (comparison.size() == 3 && comparison[1]->type != kw_in && comparison[2]->type == identifier)
+            columns.push_back(comparison[2]->value);
+    }
+    for (const Condition& child : c.children)
+        conditionColumns(child, columns);
+}
+
+// the where clause boolExprRoot on table t, simplified. a node of type kw_true or kw_false if it's the same for every row
+// boolExprRoot is left as it is
+std::shared_ptr<node> simplify(std::shared_ptr<node> boolExprRoot, const TableInfo& t) {
+    return toNode(simplify(buildCondition(boolExprRoot, false, t), t));
+}
+
+#endif
@@ -7,6 +7,7 @@
 #include <unordered_map>
 #include <algorithm>
 #include <cctype>
+#include "QueryError.hpp"
 
 const int MAX_IDENTIFIER_LENGTH = 64;
 
@@ -108,6 +109,7 @@ std::vector<token> tokenize(const std::string& statement) {
     keyword_map["bool"] = kw_bool;
     keyword_map["chars"] = kw_chars;
     keyword_map["drop"] = kw_drop;
+    keyword_map["output"] = kw_output;
     keyword_map["with"] = kw_with;
     keyword_map["temporary"] = kw_temporary;
 
@@ -135,8 +137,7 @@ std::vector<token> tokenize(const std::string& statement) {
 
             // check length
             if (word.length() > MAX_IDENTIFIER_LENGTH) {
-                std::cout << "Tokenization error on line " << line_number << ". Table/column name " << word << " is greater than 64 characters long.\n";
-                exit(1);
+                throw QueryError() << "Tokenization error on line " << line_number << ". Table/column name " << word << " is greater than 64 characters long.\n";
             }
 
             // if it contains a '.', we know the following must be a column name
@@ -151,15 +152,13 @@ std::vector<token> tokenize(const std::string& statement) {
                     }
                 }
                 else {
-                    std::cout << "Tokenization error. Expecting alpha after '.'. Had: \'" << *word_end << "\' instead.\n";
-                    exit(1);
+                    throw QueryError() << "Tokenization error. Expecting alpha after '.'. Had: \'" << *word_end << "\' instead.\n";
                 }
 
                 std::string column_name(column_name_begin, word_end);
                 // check length
                 if (column_name.length() > MAX_IDENTIFIER_LENGTH) {
-                    std::cout << "Tokenization error on line " << line_number << ". Column name " << column_name << " is greater than 64 characters long.\n";
-                    exit(1);
+                    throw QueryError() << "Tokenization error on line " << line_number << ". Column name " << column_name << " is greater than 64 characters long.\n";
                 }
             }
 
@@ -180,8 +179,7 @@ std::vector<token> tokenize(const std::string& statement) {
         // float or integer literal
         else if (isdigit(*it) || *it == '-') {
             if (*it == '-' && !isdigit(*(it+1))) {
-                std::cout << "Tokenization error on line " << line_number << ". '-' must be followed by a digit.\n";
-                exit(1);
+                throw QueryError() << "Tokenization error on line " << line_number << ". '-' must be followed by a digit.\n";
             }
             std::string::const_iterator number_end = it + 1;
             while (isdigit(*number_end))
@@ -191,8 +189,7 @@ std::vector<token> tokenize(const std::string& statement) {
             if (*number_end == '.') {
                 number_end++; // consume .
                 if (!isdigit(*number_end)) {
-                    std::cout << "Tokenization error. Expecting digit after '.'. Had \'" << *number_end << "\' instead.\n";
-                    exit(1);
+                    throw QueryError() << "Tokenization error. Expecting digit after '.'. Had \'" << *number_end << "\' instead.\n";
                 }
                 while (isdigit(*number_end))
                     number_end++;
@@ -209,8 +206,7 @@ std::vector<token> tokenize(const std::string& statement) {
                 std::stoi(number);
             }
             catch (const std::out_of_range& e) {
-                std::cout << "Tokenization error on line " << line_number << ". The integer " << number << " out of 32 bit int range.\n";
-                exit(1);
+                throw QueryError() << "Tokenization error on line " << line_number << ". The integer " << number << " out of 32 bit int range.\n";
             }
 
             tokens.push_back(token(int_literal, number, line_number));
@@ -225,8 +221,7 @@ std::vector<token> tokenize(const std::string& statement) {
             }
 
             if (chars_end == statement.end()) {
-                std::cout << "Tokenizer error. Unpaired \" on line " << line_number << ".\n";
-                exit(1);
+                throw QueryError() << "Tokenizer error. Unpaired \" on line " << line_number << ".\n";
             }
             chars_end++; // consume ending "
             
@@ -236,6 +231,21 @@ std::vector<token> tokenize(const std::string& statement) {
             it = chars_end;
         }
 
+        // parameter placeholder, ?1, ?2, ...
+        else if (*it == '?') {
+            std::string::const_iterator number_end = it + 1;
+            while (number_end != statement.end() && isdigit(*number_end))
+                number_end++;
+
+            std::string number(it + 1, number_end);
+            if (number.empty() || number.length() > 4 || std::stoi(number) == 0) {
+                throw QueryError() << "Tokenization error on line " << line_number << ". '?' must be followed by a parameter number from 1 to 9999.\n";
+            }
+
+            tokens.push_back(token(parameter, std::to_string(std::stoi(number)), line_number));
+            it = number_end;
+        }
+
         // punctuation and operators
         else if (*it == '(') {
             tokens.push_back(token(open_parenthesis, "(", line_number));
@@ -265,8 +275,7 @@ std::vector<token> tokenize(const std::string& statement) {
         else if (*it == '=') {
             it++;
             if (*it != '=') {
-                std::cout << "Error while tokenizing. Expected ==\n";
-                exit(1);
+                throw QueryError() << "Error while tokenizing. Expected ==\n";
             }
             it++;
             tokens.push_back(token(op_equals, "==", line_number));
@@ -305,8 +314,7 @@ std::vector<token> tokenize(const std::string& statement) {
         else if (*it == '&') {
             it++;
             if (*it != '&') {
-                std::cout << "Error while tokenizing. Expected &&\n";
-                exit(1);
+                throw QueryError() << "Error while tokenizing. Expected &&\n";
             }
             it++;
             tokens.push_back(token(op_and, "&&", line_number));
@@ -315,16 +323,14 @@ std::vector<token> tokenize(const std::string& statement) {
         else if (*it == '|') {
             it++;
             if (*it != '|') {
-                std::cout << "Error while tokenizing. Expected ||\n";
-                exit(1);
+                throw QueryError() << "Error while tokenizing. Expected ||\n";
             }
             it++;
             tokens.push_back(token(op_or, "||", line_number));
         }
 
         else {
-            std::cout << "Unrecognized token at: " << *it << " on line " << line_number << '\n';
-            exit(1);
+            throw QueryError() << "Unrecognized token at: " << *it << " on line " << line_number << '\n';
         }
         
     }
@@ -10,15 +10,23 @@
 #include <map>
 #include "TableInfo.hpp"
 #include "node.hpp"
+#include "QueryError.hpp"
+#include "Parameters.hpp"
 
 class Validator {
 private:
     std::vector<TableInfo> tables;
     TableInfo workingTable = TableInfo();
+    Parameters parameters;
 
 public:
 
     Validator(std::vector<TableInfo> initials) : tables(initials) {}
+
+    // the ?N placeholders found while validating, with the types they must be bound with
+    const Parameters& getParameters() const {
+        return parameters;
+    }
     
     // validate the AST
     void validate(std::shared_ptr<node> astRoot) {
@@ -30,6 +38,10 @@ public:
                     validateDrop(nodePtr);
                     break;
 
+                case output:
+                    validateOutput(nodePtr);
+                    break;
+
                 case definition:
                     validateDefinition(nodePtr);
                     break;
@@ -71,8 +83,7 @@ public:
         // table must exist
         std::string tableName = deletionRoot->components[0]->value;
         if (!exists(tableName, tables)) {
-            std::cout << "Validator error. Attempted deletion within table \"" << tableName << "\", which does not exist.\n";
-            exit(1);
+            throw QueryError() << "Validator error. Attempted deletion within table \"" << tableName << "\", which does not exist.\n";
         }
         auto t = find(tableName, tables);
 
@@ -88,28 +99,24 @@ public:
             return;
         
         if (orderRoot->components[1]->type != kw_asc && orderRoot->components[1]->type != kw_desc) {
-            std::cout << "Validator error. Somehow, ordering neither asc or desc.\n";
-            exit(1);
+            throw QueryError() << "Validator error. Somehow, ordering neither asc or desc.\n";
         }
 
         // column name must not be in table.column form
         std::string columnName = orderRoot->components[0]->value;
         if (hasDot(columnName)) {
-            std::cout << "Validator error. Ordered column \"" << t.name + '.' + columnName << "\" should not be in table.column form. Try \"" << split(columnName).second << "\".\n";
-            exit(1);
+            throw QueryError() << "Validator error. Ordered column \"" << t.name + '.' + columnName << "\" should not be in table.column form. Try \"" << split(columnName).second << "\".\n";
         }
 
         // column must exist in the table
         if (!exists(columnName, t.columns)) {
-            std::cout << "Validator error. Ordered column \"" << columnName << "\" does not exist in table \"" << t.name << "\".\n";
-            exit(1);
+            throw QueryError() << "Validator error. Ordered column \"" << columnName << "\" does not exist in table \"" << t.name << "\".\n";
         }
         auto c = find(columnName, t.columns);
         
         // column must not be a bool
         if (c->type == bool_literal) {
-            std::cout << "Validator error. Cannot order by a boolean column \"" << columnName << "\".\n";
-            exit(1);
+            throw QueryError() << "Validator error. Cannot order by a boolean column \"" << columnName << "\".\n";
         }
     }
 
@@ -119,8 +126,7 @@ public:
         // table must exist
         std::string tableName = selectionRoot->components[1]->value;
         if (!exists(tableName, tables)) {
-            std::cout << "Validator error. Table \"" << tableName << "\" mentioned in update statement into does not exist.\n";
-            exit(1);
+            throw QueryError() << "Validator error. Table \"" << tableName << "\" mentioned in update statement into does not exist.\n";
         }
         auto t = find(tableName, tables);
 
@@ -135,8 +141,7 @@ public:
             // columns must not be in table.column form
             for (auto& col : columnListRoot->components) {
                 if (hasDot(col->value)) {
-                    std::cout << "Validator error. Column \"" << col->value << "\" mentioned in selection should not be in table.column form. Try \"" << split(col->value).second << "\".\n";
-                    exit(1);
+                    throw QueryError() << "Validator error. Column \"" << col->value << "\" mentioned in selection should not be in table.column form. Try \"" << split(col->value).second << "\".\n";
                 }
             }
 
@@ -145,8 +150,7 @@ public:
             std::vector<std::string> colNames;
             for (auto& col : columnListRoot->components) {
                 if (std::find(colNames.begin(), colNames.end(), col->value) != colNames.end()) {
-                    std::cout << "Validator error. Attempted to select column \"" << col->value << "\" twice from table \"" << t->name << "\".\n";
-                    exit(1); 
+                    throw QueryError() << "Validator error. Attempted to select column \"" << col->value << "\" twice from table \"" << t->name << "\".\n";
                 }
                 colNames.push_back(col->value);
             }
@@ -154,8 +158,7 @@ public:
             // column must exist in table
             for (auto& c : columnListRoot->components) {
                 if (!exists(c->value, t->columns)) {
-                    std::cout << "Validator error. Selected column \"" << c->value << "\" does not exist in table \"" << t->name << "\".\n";
-                    exit(1);
+                    throw QueryError() << "Validator error. Selected column \"" << c->value << "\" does not exist in table \"" << t->name << "\".\n";
                 }
             }
         }
@@ -163,6 +166,13 @@ public:
         validateWhereClause(selectionRoot->components[3], *t);
         validateOrderClause(selectionRoot->components[4], *t);
 
+        // distinct rows are only in one order if the ordered column is one of them
+        auto orderRoot = selectionRoot->components[4];
+        if (selectionRoot->components[0]->type == kw_distinct && orderRoot->type != nullnode && columnListRoot->components[0]->type != asterisk
+            && std::none_of(columnListRoot->components.begin(), columnListRoot->components.end(), [&](auto& c) { return c->value == orderRoot->components[0]->value; })) {
+            throw QueryError() << "Validator error. Ordered column \"" << orderRoot->components[0]->value << "\" must be selected to order a distinct selection.\n";
+        }
+
         std::vector<ColumnInfo> workingColumns;
         // asterisk
         if (columnListRoot->components[0]->type == asterisk)
@@ -181,6 +191,24 @@ public:
         // std::cout << "Selection validated.\n\n";
     }
 
+    // the columns a where clause compares. the rhs of an in, any, or all is another table's, so it isn't one
+    void comparedColumns(std::shared_ptr<node> boolExprRoot, std::vector<std::string>& columns) {
+        auto& components = boolExprRoot->components;
+        if (components.size() == 1)
+            comparedColumns(components[0], columns);
+        else if (components[0]->type == op_not)
+            comparedColumns(components[1], columns);
+        else if (components[1]->type == op_or || components[1]->type == op_and) {
+            comparedColumns(components[0], columns);
+            comparedColumns(components[2], columns);
+        }
+        else {
+            columns.push_back(components[0]->value);
+            if (components.size() == 3 && components[1]->type != kw_in && components[2]->type == identifier)
+                columns.push_back(components[2]->value);
+        }
+    }
+
     // validate boolean expression
     void validateBoolExpr(std::shared_ptr<node> boolExprRoot, const TableInfo& t) {
         
@@ -213,13 +241,11 @@ public:
         // column names must not be in table.column form
         std::string lhsColumnName = boolExprRoot->components[0]->value;
         if (hasDot(lhsColumnName)) {
-            std::cout << "Validator error. Column \"" << lhsColumnName << "\" should not be in table.column form. Try \"" << split(lhsColumnName).second << "\".\n";
-            exit(1);   
+            throw QueryError() << "Validator error. Column \"" << lhsColumnName << "\" should not be in table.column form. Try \"" << split(lhsColumnName).second << "\".\n";
         }
         // column must be in table
         if (!exists(lhsColumnName, t.columns)) {
-            std::cout << "Validator error. Column \"" << lhsColumnName << "\" doesn't exist in table \"" << t.name << "\".\n";
-            exit(1);
+            throw QueryError() << "Validator error. Column \"" << lhsColumnName << "\" doesn't exist in table \"" << t.name << "\".\n";
         }
         auto lhsColumn = find(lhsColumnName, t.columns);
 
@@ -229,31 +255,27 @@ public:
 
             std::string rhsIdentifier = boolExprRoot->components[2]->value;
             if (!hasDot(rhsIdentifier)) {
-                std::cout << "Validator error. Column \"" << rhsIdentifier << "\" in boolean expression must be in table.column form.\n";
-                exit(1);   
+                throw QueryError() << "Validator error. Column \"" << rhsIdentifier << "\" in boolean expression must be in table.column form.\n";
             }
 
             // rhs table must exist
             std::string rhsColumnName = split(rhsIdentifier).second;
             std::string rhsTableName = split(rhsIdentifier).first;
             if (!exists(rhsTableName, tables)) {
-                std::cout << "Validator error. Table \"" << rhsTableName << "\" mentioned in \"" << rhsIdentifier << "\" in boolean expression does not exist!\n";
-                exit(1);   
+                throw QueryError() << "Validator error. Table \"" << rhsTableName << "\" mentioned in \"" << rhsIdentifier << "\" in boolean expression does not exist!\n";
             }
             auto rhsTable = find(rhsTableName, tables);
 
             // column must be in table
             if (!exists(rhsColumnName, rhsTable->columns)) {
-                std::cout << "Validator error. Column \"" << rhsColumnName << "\" mentioned in boolean expression doesn't exist in table \"" << rhsTable->name << "\".\n";
-                exit(1);
+                throw QueryError() << "Validator error. Column \"" << rhsColumnName << "\" mentioned in boolean expression doesn't exist in table \"" << rhsTable->name << "\".\n";
             }
             auto rhsColumn = find(rhsColumnName, rhsTable->columns);
             
             // check that lhs column and rhs column are the same type
             if (lhsColumn->type != rhsColumn->type) {
-                std::cout << "Validator error. Types conflict in boolean expression when checking if " << tokenTypeToString(lhsColumn->type) << " \""
-                          << t.name + '.' + lhsColumnName << "\" is in " << tokenTypeToString(rhsColumn->type) << " \"" << rhsIdentifier << "\".\n";
-                exit(1);
+                throw QueryError() << "Validator error. Types conflict in boolean expression when checking if " << tokenTypeToString(lhsColumn->type) << " \""
+                                   << t.name + '.' + lhsColumnName << "\" is in " << tokenTypeToString(rhsColumn->type) << " \"" << rhsIdentifier << "\".\n";
             }
             
             return;
@@ -264,42 +286,39 @@ public:
 
             std::string rhsIdentifier = boolExprRoot->components[3]->value;
             if (!hasDot(rhsIdentifier)) {
-                std::cout << "Validator error. Column \"" << rhsIdentifier << "\" in boolean expression must be in table.column form.\n";
-                exit(1);   
+                throw QueryError() << "Validator error. Column \"" << rhsIdentifier << "\" in boolean expression must be in table.column form.\n";
             }
 
             // rhs table must exist
             std::string rhsColumnName = split(rhsIdentifier).second;
             std::string rhsTableName = split(rhsIdentifier).first;
             if (!exists(rhsTableName, tables)) {
-                std::cout << "Validator error. Table \"" << rhsTableName << "\" mentioned in \"" << rhsIdentifier << "\" in boolean expression does not exist!\n";
-                exit(1);   
+                throw QueryError() << "Validator error. Table \"" << rhsTableName << "\" mentioned in \"" << rhsIdentifier << "\" in boolean expression does not exist!\n";
             }
             auto rhsTable = find(rhsTableName, tables);
 
             // column must be in table
             if (!exists(rhsColumnName, rhsTable->columns)) {
-                std::cout << "Validator error. Column \"" << rhsColumnName << "\" mentioned in boolean expression doesn't exist in table \"" << rhsTable->name << "\".\n";
-                exit(1);
+                throw QueryError() << "Validator error. Column \"" << rhsColumnName << "\" mentioned in boolean expression doesn't exist in table \"" << rhsTable->name << "\".\n";
             }
             auto rhsColumn = find(rhsColumnName, rhsTable->columns);
             
             // check that lhs column and rhs column are the same type
             if (lhsColumn->type != rhsColumn->type) {
-                std::cout << "Validator error. Types conflict in boolean expression when comparing " << tokenTypeToString(lhsColumn->type) << " \""
-                          << t.name + '.' + lhsColumnName << "\" to all/any " << tokenTypeToString(rhsColumn->type) << " \"" << rhsIdentifier << "\".\n";
-                exit(1);
+                throw QueryError() << "Validator error. Types conflict in boolean expression when comparing " << tokenTypeToString(lhsColumn->type) << " \""
+                                   << t.name + '.' + lhsColumnName << "\" to all/any " << tokenTypeToString(rhsColumn->type) << " \"" << rhsIdentifier << "\".\n";
             }
 
             // disallow <>= of bool columns
             element_type opType = boolExprRoot->components[1]->type;
             if (lhsColumn->type == bool_literal && (opType >= op_less_than && opType <= op_greater_than_equals)) {
-                std::cout << "Validator error. Tried to use operator " << tokenTypeToString(opType)
-                          << " with bool column \"" << t.name + '.' + lhsColumn->name << "\".\n";
+                QueryError error;
+                error << "Validator error. Tried to use operator " << tokenTypeToString(opType)
+                      << " with bool column \"" << t.name + '.' + lhsColumn->name << "\".\n";
                 if (rhsColumn->type == bool_literal) {
-                    std::cout << "Column \"" << rhsIdentifier << "\" is also of type bool.\n";
+                    error << "Column \"" << rhsIdentifier << "\" is also of type bool.\n";
                 }                          
-                exit(1);
+                throw error;
             }
             
             return;
@@ -314,12 +333,23 @@ public:
             element_type rhsType = boolExprRoot->components[2]->type;
             auto rhsValue = boolExprRoot->components[2]->value;
 
+            // rhs parameter, takes the type of the column
+            if (rhsType == parameter) {
+                // disallow <>= on bool columns, same as for true and false
+                element_type opType = boolExprRoot->components[1]->type;
+                if (c->type == bool_literal && (opType >= op_less_than && opType <= op_greater_than_equals)) {
+                    throw QueryError() << "Validator error. Tried to use operator " << tokenTypeToString(opType)
+                                       << " with bool column \"" << t.name + '.' + c->name << "\" and parameter ?" << rhsValue << ".\n";
+                }
+                parameters.declare(stoi(rhsValue), c->type, 0, true);
+                return;
+            }
+
             if (rhsType != kw_null && rhsType != identifier) {  
                 // @TODO can we guarantee that c->type is int, float chars, or bool literal?
                 if (c->type != rhsType) {
-                    std::cout << "Validator error. Type error in boolean expression between " << tokenTypeToString(c->type) << " column \"" 
-                                << t.name + '.' + c->name << "\" and the attempted comparison to " << tokenTypeToString(rhsType) << ' ' << rhsValue << ".\n";
-                    exit(1);
+                    throw QueryError() << "Validator error. Type error in boolean expression between " << tokenTypeToString(c->type) << " column \"" 
+                                         << t.name + '.' + c->name << "\" and the attempted comparison to " << tokenTypeToString(rhsType) << ' ' << rhsValue << ".\n";
                 }
             }
             
@@ -327,33 +357,31 @@ public:
             if (rhsType == identifier) {
                 // must not be in table.column form
                 if (hasDot(rhsValue)) {
-                    std::cout << "Validator error. Column \"" << rhsValue << "\" mentioned in a boolean expression should not be in table.column form.\n";
-                    exit(1);
+                    throw QueryError() << "Validator error. Column \"" << rhsValue << "\" mentioned in a boolean expression should not be in table.column form.\n";
                 }
 
                 // column must exist in t
                 if (!exists(rhsValue, t.columns)) {
-                    std::cout << "Validator error. Column \"" << rhsValue << "\" does not exist in table \"" << t.name << "\".\n";
-                    exit(1);    
+                    throw QueryError() << "Validator error. Column \"" << rhsValue << "\" does not exist in table \"" << t.name << "\".\n";
                 }
                 auto rhsC = find(rhsValue, t.columns);
 
                 // lhs and rhs columns must be same type
                 if (c->type != rhsC->type) {
-                    std::cout << "Validator error. Type conflict in boolean expression when comparing " << tokenTypeToString(c->type) << " \"" << c->name
-                              << "\" to " << tokenTypeToString(rhsC->type) << " \"" << rhsValue << "\".\n.";
-                    exit(1);
+                    throw QueryError() << "Validator error. Type conflict in boolean expression when comparing " << tokenTypeToString(c->type) << " \"" << c->name
+                                       << "\" to " << tokenTypeToString(rhsC->type) << " \"" << rhsValue << "\".\n.";
                 }
 
                 // disallow <>= on bool columns
                 element_type opType = boolExprRoot->components[1]->type;
                 if (lhsColumn->type == bool_literal && (opType >= op_less_than && opType <= op_greater_than_equals)) {
-                    std::cout << "Validator error. Tried to use operator " << tokenTypeToString(opType)
-                            << " with bool column \"" << t.name + '.' + lhsColumn->name << "\".\n";
+                    QueryError error;
+                    error << "Validator error. Tried to use operator " << tokenTypeToString(opType)
+                          << " with bool column \"" << t.name + '.' + lhsColumn->name << "\".\n";
                     if (rhsC->type == bool_literal) {
-                        std::cout << "Column \"" << rhsValue << "\" is also of type bool.\n";
+                        error << "Column \"" << rhsValue << "\" is also of type bool.\n";
                     }                          
-                    exit(1);
+                    throw error;
                 }
             }
 
@@ -377,15 +405,13 @@ public:
         // table must exist
         std::string tableName = updateRoot->components[0]->value;
         if (!exists(tableName, tables)) {
-            std::cout << "Validator error. Table \"" << tableName << "\" mentioned in update statement into does not exist.\n";
-            exit(1);
+            throw QueryError() << "Validator error. Table \"" << tableName << "\" mentioned in update statement into does not exist.\n";
         }
 
         // columns must not be in table.column form
         for (auto& columnValuePair : columnValueListRoot->components) {
             if (hasDot(columnValuePair->components[0]->value)) {
-                std::cout << "Validator error. Column \"" << columnValuePair->components[0]->value << "\" mentioned in update statement should not be in table.column form. Try \"" << split(columnValuePair->components[0]->value).second << "\".\n";
-                exit(1);
+                throw QueryError() << "Validator error. Column \"" << columnValuePair->components[0]->value << "\" mentioned in update statement should not be in table.column form. Try \"" << split(columnValuePair->components[0]->value).second << "\".\n";
             }
         }
 
@@ -393,8 +419,7 @@ public:
         auto t = find(tableName, tables);
         for (auto& columnValuePair : columnValueListRoot->components) {
             if (!exists(columnValuePair->components[0]->value , t->columns)) {
-                std::cout << "Validator error. Column \"" << columnValuePair->components[0]->value << "\" does not exist in table \"" << t->name << "\".\n";
-                exit(1);     
+                throw QueryError() << "Validator error. Column \"" << columnValuePair->components[0]->value << "\" does not exist in table \"" << t->name << "\".\n";
             }
         }
 
@@ -407,13 +432,18 @@ public:
             // a null can be updateed in any column
             if (pairType == kw_null)
                 continue;
+
+            // a parameter takes the type of the column
+            if (pairType == parameter) {
+                parameters.declare(stoi(pairValue), c->type, (c->type == chars_literal ? c->charsLength : 0), false);
+                continue;
+            }
             
             // @TODO can we guarantee that c->type is int, float chars, or bool literal?
             // ex: if the node is an int literal, the column type must also be an int literal
             if (c->type != pairType) {
-                std::cout << "Validator error. Column \"" << t->name + '.' + c->name << "\" is of type " << tokenTypeToString(c->type) << ", but an update of "
-                        << tokenTypeToString(pairType) << " " << pairValue << " was attempted.\n";
-                exit(1);
+                throw QueryError() << "Validator error. Column \"" << t->name + '.' + c->name << "\" is of type " << tokenTypeToString(c->type) << ", but an update of "
+                                 << tokenTypeToString(pairType) << " " << pairValue << " was attempted.\n";
             }
         }
 
@@ -421,8 +451,7 @@ public:
         std::vector<std::string> colNames;
         for (auto& columnValuePair : columnValueListRoot->components) {
             if (std::find(colNames.begin(), colNames.end(), columnValuePair->components[0]->value) != colNames.end()) {
-                std::cout << "Validator error. There were two updates of column \"" << t->name + '.' + columnValuePair->components[0]->value << "\" within the same statement.\n";
-                exit(1); 
+                throw QueryError() << "Validator error. There were two updates of column \"" << t->name + '.' + columnValuePair->components[0]->value << "\" within the same statement.\n";
             }
             colNames.push_back(columnValuePair->components[0]->value);
         }
@@ -431,8 +460,7 @@ public:
         for (auto& columnValuePair : columnValueListRoot->components) {
             auto c = find(columnValuePair->components[0]->value, t->columns);
             if (columnValuePair->components[1]->type == chars_literal && columnValuePair->components[1]->value.length() > c->charsLength) {
-                std::cout << "Validator error. The maximum string length of \"" <<  t->name + '.' + columnValuePair->components[0]->value << "\" is " << c->charsLength << " character(s).\n";
-                exit(1);  
+                throw QueryError() << "Validator error. The maximum string length of \"" <<  t->name + '.' + columnValuePair->components[0]->value << "\" is " << c->charsLength << " character(s).\n";
             }
         }
 
@@ -452,15 +480,13 @@ public:
         // table must exist
         std::string tableName = insertionRoot->components[0]->value;
         if (!exists(tableName, tables)) {
-            std::cout << "Validator error. Table \"" << tableName << "\" mentioned in insert statement does not exist.\n";
-            exit(1);
+            throw QueryError() << "Validator error. Table \"" << tableName << "\" mentioned in insert statement does not exist.\n";
         }
 
         // columns must not be in table.column form
         for (auto& columnValuePair : columnValueListRoot->components) {
             if (hasDot(columnValuePair->components[0]->value)) {
-                std::cout << "Validator error. Column \"" << columnValuePair->components[0]->value << "\" mentioned in insert statement should not be in table.column form. Try \"" << split(columnValuePair->components[0]->value).second << "\".\n";
-                exit(1);
+                throw QueryError() << "Validator error. Column \"" << columnValuePair->components[0]->value << "\" mentioned in insert statement should not be in table.column form. Try \"" << split(columnValuePair->components[0]->value).second << "\".\n";
             }
         }
 
@@ -468,8 +494,7 @@ public:
         auto t = find(tableName, tables);
         for (auto& columnValuePair : columnValueListRoot->components) {
             if (!exists(columnValuePair->components[0]->value , t->columns)) {
-                std::cout << "Validator error. Column \"" << columnValuePair->components[0]->value << "\" does not exist in table \"" << t->name << "\".\n";
-                exit(1);     
+                throw QueryError() << "Validator error. Column \"" << columnValuePair->components[0]->value << "\" does not exist in table \"" << t->name << "\".\n";
             }
         }
 
@@ -482,13 +507,18 @@ public:
             // a null can be updateed in any column
             if (pairType == kw_null)
                 continue;
+
+            // a parameter takes the type of the column
+            if (pairType == parameter) {
+                parameters.declare(stoi(pairValue), c->type, (c->type == chars_literal ? c->charsLength : 0), false);
+                continue;
+            }
             
             // @TODO can we guarantee that c->type is int, float chars, or bool literal?
             // ex: if the node is an int literal, the column type must also be an int literal
             if (c->type != pairType) {
-                std::cout << "Validator error. Column \"" << t->name + '.' + c->name << "\" is of type " << tokenTypeToString(c->type) 
-                          << ", but an insert of " << tokenTypeToString(pairType) << " " << pairValue << " was attempted.\n";
-                exit(1);
+                throw QueryError() << "Validator error. Column \"" << t->name + '.' + c->name << "\" is of type " << tokenTypeToString(c->type) 
+                                   << ", but an insert of " << tokenTypeToString(pairType) << " " << pairValue << " was attempted.\n";
             }
         }
 
@@ -496,8 +526,7 @@ public:
         std::vector<std::string> colNames;
         for (auto& columnValuePair : columnValueListRoot->components) {
             if (std::find(colNames.begin(), colNames.end(), columnValuePair->components[0]->value) != colNames.end()) {
-                std::cout << "Validator error. There were two insertions into column \"" << t->name + '.' + columnValuePair->components[0]->value << "\" within the same statement.\n";
-                exit(1); 
+                throw QueryError() << "Validator error. There were two insertions into column \"" << t->name + '.' + columnValuePair->components[0]->value << "\" within the same statement.\n";
             }
             colNames.push_back(columnValuePair->components[0]->value);
         }
@@ -506,8 +535,7 @@ public:
         for (auto& columnValuePair : columnValueListRoot->components) {
             auto c = find(columnValuePair->components[0]->value, t->columns);
             if (columnValuePair->components[1]->type == chars_literal && columnValuePair->components[1]->value.length() > c->charsLength) {
-                std::cout << "Validator error. The maximum string length of \"" <<  t->name + '.' + columnValuePair->components[0]->value << "\" is " << c->charsLength << " character(s).\n";
-                exit(1);  
+                throw QueryError() << "Validator error. The maximum string length of \"" <<  t->name + '.' + columnValuePair->components[0]->value << "\" is " << c->charsLength << " character(s).\n";
             }
         }
 
@@ -516,147 +544,186 @@ public:
         // std::cout << "Insert validated.\n\n";
     }
 
-    // validate join statement
+    // validate join statement, of two or more tables
     void validateJoin(std::shared_ptr<node> joinRoot) {
 
         // cannot join tables that don't exist
-        std::string table1Name = joinRoot->components[0]->value;
-        if (!exists(table1Name, tables)) {
-            std::cout << "Validator error. Table \"" << table1Name << "\" doesn't exist.\n";
-            exit(1);
+        std::vector<std::string> tableNames = joinTableNames(joinRoot);
+        std::vector<std::vector<TableInfo>::const_iterator> joinedTables;
+        for (auto& tableName : tableNames) {
+            if (!exists(tableName, tables)) {
+                throw QueryError() << "Validator error. Table \"" << tableName << "\" doesn't exist.\n";
+            }
+            joinedTables.push_back(find(tableName, tables));
         }
-        std::string table2Name = joinRoot->components[1]->value;
-        if (!exists(table2Name, tables)) {
-            std::cout << "Validator error. Table \"" << table2Name << "\" doesn't exist.\n";
-            exit(1);
+
+        // only a join of two tables can join a table with itself. past that, table.column couldn't tell which one is meant
+        if (tableNames.size() > 2) {
+            for (size_t i = 0; i < tableNames.size(); ++i) {
+                if (std::find(tableNames.begin(), tableNames.begin() + i, tableNames[i]) != tableNames.begin() + i) {
+                    throw QueryError() << "Validator error. Table \"" << tableNames[i] << "\" is joined more than once. Only a join of two tables may join a table with itself.\n";
+                }
+            }
         }
 
         // new aliases cannot exceed 64 characters
         // handled implicitly in tokenizer, with MAX_IDENTIFIER_LENGTH
 
-        // ON_EXPR
-        std::shared_ptr<node> onExprRoot = joinRoot->components[2];
-
-        // joined columns must be in table.column form
-        std::string col1Name = onExprRoot->components[0]->value;
-        if (!hasDot(col1Name)) {
-            std::cout << "Validator error. Column \"" << col1Name << "\" isn't in table.column form.\n";
-            exit(1);
-        }
-        std::string col2Name = onExprRoot->components[2]->value;
-        if (!hasDot(col2Name)) {
-            std::cout << "Validator error. Column \"" << col1Name << "\" isn't in table.column form.\n";
-            exit(1);
+        // ON_EXPRS
+        // every table must be joined to the others, so n tables need at least n - 1 on exprs
+        std::vector<std::shared_ptr<node>> conditions = joinConditions(joinRoot);
+        if (conditions.size() < tableNames.size() - 1) {
+            throw QueryError() << "Validator error. A join of " << tableNames.size() << " tables needs at least " << tableNames.size() - 1
+                               << " on expressions, but there are " << conditions.size() << ".\n";
         }
 
-        // verify that joined column names reference joined tables
-        auto split1 = split(col1Name);
-        auto split2 = split(col2Name);
-        if (split1.first == joinRoot->components[0]->value && split2.first == joinRoot->components[1]->value) {}
-        else if (split2.first == joinRoot->components[0]->value && split1.first == joinRoot->components[1]->value) {}
-        else {
-            std::cout << "Validator error. Columns to join on must reference the tables stated after \"join\"!\n";
-            exit(1); 
-        }
+        // which tables the on exprs so far join together, by the lowest index among them
+        std::vector<size_t> joinedTo(tableNames.size());
+        for (size_t i = 0; i < joinedTo.size(); ++i)
+            joinedTo[i] = i;
 
-        // @TODO use overloaded exists()
-        // cannot join tables on columns that the tables don't have
-        auto table1 = find(table1Name, tables);
-        auto table2 = find(table2Name, tables);
-        // verify that the joined columns exist in their respective tables
-        auto joinedColumn1 = std::find_if(table1->columns.begin(), table1->columns.end(), [&split1](const auto& c){return c.name == split1.second;});
-        if (joinedColumn1 == table1->columns.end()) {
-            std::cout << "Validator error. Column \"" << split1.second << "\" isn't a column in table \"" << table1->name << "\".\n";
-            exit(1);
-        }
-        auto joinedColumn2 = std::find_if(table2->columns.begin(), table2->columns.end(), [&split2](const auto& c){return c.name == split2.second;});
-        if (joinedColumn2 == table2->columns.end()) {
-            std::cout << "Validator error. Column \"" << split2.second << "\" isn't a column in table \"" << table2->name << "\".\n";
-            exit(1);
-        }
+        for (auto& onExprRoot : conditions) {
 
-        // joined columns must be of the same type
-        if (joinedColumn1->type != joinedColumn2->type) {
-            std::cout << "Validator error. Column \"" << col1Name << "\" is type " << joinedColumn1->type << ", and \"" << col2Name << "\" is type " << joinedColumn2->type << ".\n";
-            exit(1);
+            // joined columns must be in table.column form
+            std::string col1Name = onExprRoot->components[0]->value;
+            if (!hasDot(col1Name)) {
+                throw QueryError() << "Validator error. Column \"" << col1Name << "\" isn't in table.column form.\n";
+            }
+            std::string col2Name = onExprRoot->components[2]->value;
+            if (!hasDot(col2Name)) {
+                throw QueryError() << "Validator error. Column \"" << col1Name << "\" isn't in table.column form.\n";
+            }
+
+            // verify that joined column names reference joined tables
+            auto split1 = split(col1Name);
+            auto split2 = split(col2Name);
+            size_t index1 = std::find(tableNames.begin(), tableNames.end(), split1.first) - tableNames.begin();
+            size_t index2 = std::find(tableNames.begin(), tableNames.end(), split2.first) - tableNames.begin();
+            if (index1 == tableNames.size() || index2 == tableNames.size()) {
+                throw QueryError() << "Validator error. Columns to join on must reference the tables stated after \"join\"!\n";
+            }
+            // a table joined with itself: the first column is in the first copy, and the second in the second
+            if (index1 == index2 && tableNames.size() == 2)
+                index2 = 1;
+            else if (index1 == index2) {
+                throw QueryError() << "Validator error. Columns \"" << col1Name << "\" and \"" << col2Name << "\" are both in table \"" << split1.first
+                                   << "\". An on expression must compare columns of two different tables.\n";
+            }
+
+            // @TODO use overloaded exists()
+            // cannot join tables on columns that the tables don't have
+            auto table1 = joinedTables[index1];
+            auto table2 = joinedTables[index2];
+            // verify that the joined columns exist in their respective tables
+            auto joinedColumn1 = std::find_if(table1->columns.begin(), table1->columns.end(), [&split1](const auto& c){return c.name == split1.second;});
+            if (joinedColumn1 == table1->columns.end()) {
+                throw QueryError() << "Validator error. Column \"" << split1.second << "\" isn't a column in table \"" << table1->name << "\".\n";
+            }
+            auto joinedColumn2 = std::find_if(table2->columns.begin(), table2->columns.end(), [&split2](const auto& c){return c.name == split2.second;});
+            if (joinedColumn2 == table2->columns.end()) {
+                throw QueryError() << "Validator error. Column \"" << split2.second << "\" isn't a column in table \"" << table2->name << "\".\n";
+            }
+
+            // joined columns must be of the same type
+            if (joinedColumn1->type != joinedColumn2->type) {
+                throw QueryError() << "Validator error. Column \"" << col1Name << "\" is type " << joinedColumn1->type << ", and \"" << col2Name << "\" is type " << joinedColumn2->type << ".\n";
+            }
+
+            // disallow <>= on bool columns in on expr
+            element_type opType = onExprRoot->components[1]->type;
+            if (joinedColumn1->type == bool_literal && (opType >= op_less_than && opType <= op_greater_than_equals)) {
+                throw QueryError() << "Validator error. Attempted to join on two bool columns \"" << col1Name << "\" and \"" << col2Name << "\", but the comparison is neither '==' nor '!='.\n";                     
+            }
+
+            size_t from = std::max(joinedTo[index1], joinedTo[index2]);
+            size_t to = std::min(joinedTo[index1], joinedTo[index2]);
+            for (size_t& group : joinedTo)
+                if (group == from)
+                    group = to;
         }
 
-        // disallow <>= on bool columns in on expr
-        element_type opType = onExprRoot->components[1]->type;
-        if (joinedColumn1->type == bool_literal && (opType >= op_less_than && opType <= op_greater_than_equals)) {
-            std::cout << "Validator error. Attempted to join on two bool columns \"" << col1Name << "\" and \"" << col2Name << "\", but the comparison is neither '==' nor '!='.\n";                     
-            exit(1);
+        for (size_t i = 0; i < tableNames.size(); ++i) {
+            if (joinedTo[i] != 0) {
+                throw QueryError() << "Validator error. No on expression joins table \"" << tableNames[i] << "\" to table \"" << tableNames[0] << "\", directly or through other tables.\n";
+            }
         }
 
         // @NOTE: if there are vestiges of joined column alias in on_expr, remove them.
 
         // ALIAS LIST
-        std::shared_ptr<node> aliasListRoot = joinRoot->components[3];
+        std::shared_ptr<node> aliasListRoot = joinAliasList(joinRoot);
 
         // require aliasing on column name conflicts
         std::vector<std::string> conflictingColumnNames;
         // identify all conflicting names
-        for (auto& col : table1->columns) {
-            if (exists(col.name, table2->columns)) 
-                conflictingColumnNames.push_back(col.name);
+        for (size_t i = 0; i < joinedTables.size(); ++i) {
+            for (auto& col : joinedTables[i]->columns) {
+                for (size_t j = i + 1; j < joinedTables.size(); ++j) {
+                    if (exists(col.name, joinedTables[j]->columns) && std::find(conflictingColumnNames.begin(), conflictingColumnNames.end(), col.name) == conflictingColumnNames.end())
+                        conflictingColumnNames.push_back(col.name);
+                }
+            }
         }
         // if there is at least one name conflict, make sure alias list is not nullnode
         if (conflictingColumnNames.size() != 0 && aliasListRoot->type == nullnode) {
-            std::cout << "Validator error. There are name conflicts in a join, but no alias list.\n";
-            exit(1);
+            throw QueryError() << "Validator error. There are name conflicts in a join, but no alias list.\n";
         }
-        // for each conflicting name, check that table1.name or table2.name is aliased
+        // for each conflicting name, check that it is aliased on all but one of the tables that have it
         for (auto& name : conflictingColumnNames) {
-            // need to find in aliasList where alias->components[0]->value == "(table1||table2).name".
-            auto it_alias = std::find_if(aliasListRoot->components.begin(), aliasListRoot->components.end(), 
-                                        [&name, &table1, &table2](const auto& aliasRoot){
-                                            return aliasRoot->components[0]->value == table1->name + '.' + name ||  aliasRoot->components[0]->value == table2->name + '.' + name; 
-                                        });
+            std::vector<std::string> unaliased;
+            for (size_t i = 0; i < joinedTables.size(); ++i) {
+                if (!exists(name, joinedTables[i]->columns))
+                    continue;
+                // need to find in aliasList where alias->components[0]->value == "table.name".
+                // a table joined with itself can't tell its copies apart, so aliasing either copy's column is enough, as it aliases both
+                auto it_alias = std::find_if(aliasListRoot->components.begin(), aliasListRoot->components.end(), 
+                                            [&name, &joinedTables, i](const auto& aliasRoot){
+                                                return aliasRoot->components[0]->value == joinedTables[i]->name + '.' + name; 
+                                            });
+                if (it_alias == aliasListRoot->components.end())
+                    unaliased.push_back(joinedTables[i]->name);
+            }
             // if not found require alias
-            if (it_alias == aliasListRoot->components.end()) {
-                std::cout << "Validator error. Column \"" << name << "\" needs an alias on table \"" << table1->name << "\" or table \"" << table2->name << "\".\n";
-                exit(1);
+            if (unaliased.size() > 1) {
+                QueryError error;
+                error << "Validator error. Column \"" << name << "\" needs an alias on ";
+                if (unaliased.size() > 2)
+                    error << "all but one of ";
+                for (size_t i = 0; i < unaliased.size(); ++i)
+                    error << (i == 0 ? "" : " or ") << "table \"" << unaliased[i] << "\"";
+                throw error << ".\n";
             }
         }
 
         // all columns to alias must be in table.column form
         for (auto& aliasRoot : aliasListRoot->components) {
             if(!hasDot(aliasRoot->components[0]->value)) {
-                std::cout << "Validator error. Aliased column \"" << aliasRoot->components[0]->value << "\" is not in table.column form.\n";
-                exit(1);
+                throw QueryError() << "Validator error. Aliased column \"" << aliasRoot->components[0]->value << "\" is not in table.column form.\n";
             }
         }
 
         // all aliases must NOT be in table.column form
         for (auto& aliasRoot : aliasListRoot->components) {
             if(hasDot(aliasRoot->components[1]->value)) {
-                std::cout << "Validator error. Alias \"" << aliasRoot->components[1]->value << "\" must not be in table.column form.\n";
-                exit(1);
+                throw QueryError() << "Validator error. Alias \"" << aliasRoot->components[1]->value << "\" must not be in table.column form.\n";
             }
         }
 
-        // that table must be either table1 or table2
+        // that table must be one of the joined tables
         // cannot alias columns that the tables don't have
         for (auto& aliasRoot : aliasListRoot->components) {
             auto aliasedName = split(aliasRoot->components[0]->value);
 
             // find which table to use
-            auto it_table = tables.cend();
-            if (aliasedName.first == table1->name)
-                it_table = table1;
-            else if (aliasedName.first == table2->name)
-                it_table = table2;
-            // in neither
-            else {
-                std::cout << "Validator error. Aliased column \"" << aliasRoot->components[0]->value << "\" references table \"" << aliasedName.first
-                          << "\", which is neither of the joined tables.\n";
-                exit(1);
+            size_t index = std::find(tableNames.begin(), tableNames.end(), aliasedName.first) - tableNames.begin();
+            if (index == tableNames.size()) {
+                throw QueryError() << "Validator error. Aliased column \"" << aliasRoot->components[0]->value << "\" references table \"" << aliasedName.first
+                                   << "\", which is " << (tableNames.size() == 2 ? "neither" : "not one") << " of the joined tables.\n";
             }
             
             // check if the column is in the table
-            if (!exists(aliasedName.second, it_table->columns)) {
-                std::cout << "Validator error. Aliased column \"" << aliasRoot->components[0]->value << "\" doesn't exist.\n";
-                exit(1);
+            if (!exists(aliasedName.second, joinedTables[index]->columns)) {
+                throw QueryError() << "Validator error. Aliased column \"" << aliasRoot->components[0]->value << "\" doesn't exist.\n";
             }
         }
 
@@ -665,8 +732,7 @@ public:
         for (auto& aliasRoot : aliasListRoot->components) {
             std::string aliasedName = aliasRoot->components[0]->value;
             if (std::find(names.begin(), names.end(), aliasedName) != names.end()) {
-                std::cout << "Validator error. Multiple aliases of column \"" << aliasedName << "\".\n";
-                exit(1);
+                throw QueryError() << "Validator error. Multiple aliases of column \"" << aliasedName << "\".\n";
             }
             names.push_back(aliasedName);
         }
@@ -675,28 +741,23 @@ public:
         // e.g. if t1.x is aliased to x1, t2.y cannot be aliased to x
         // allow that kind of thing (low-priority, this could cause headaches anyways)
 
-        // alias names must not conflict with eachother or columns in table1 or table2
+        // alias names must not conflict with eachother or columns in the joined tables
         std::vector<std::string> aliases;
         for (auto& aliasRoot : aliasListRoot->components) {
             std::string aliasName = aliasRoot->components[1]->value;
 
             // conflicting aliases
             if (std::find(aliases.begin(), aliases.end(), aliasName) != aliases.end()) {
-                std::cout << "Validator error. Attempted to alias two columns to the same name: \"" << aliasName << "\".\n";
-                exit(1);
+                throw QueryError() << "Validator error. Attempted to alias two columns to the same name: \"" << aliasName << "\".\n";
             }
             aliases.push_back(aliasName);
 
-            // conflict with a column in table1 or table2
-            if (exists(aliasName, table1->columns)) {
-                std::cout << "Validator error. Alias \"" << aliasName << "\" of column \"" << aliasRoot->components[0]->value 
-                          << "\" conflicts with column \"" << aliasName << "\" in table \"" << table1->name << "\".\n";
-                exit(1);
-            }
-            if (exists(aliasName, table2->columns)) {
-                std::cout << "Validator error. Alias \"" << aliasName << "\" of column \"" << aliasRoot->components[0]->value 
-                          << "\" conflicts with column \"" << aliasName << "\" in table \"" << table2->name << "\".\n";
-                exit(1);
+            // conflict with a column in a joined table
+            for (auto& table : joinedTables) {
+                if (exists(aliasName, table->columns)) {
+                    throw QueryError() << "Validator error. Alias \"" << aliasName << "\" of column \"" << aliasRoot->components[0]->value 
+                                       << "\" conflicts with column \"" << aliasName << "\" in table \"" << table->name << "\".\n";
+                }
             }
         }
 
@@ -709,7 +770,7 @@ public:
             nameToAlias.insert({aliasRoot->components[0]->value, aliasRoot->components[1]->value});
 
         // go through columns of each table
-        for (const auto& t : {table1, table2}) {
+        for (const auto& t : joinedTables) {
             for (const ColumnInfo& c : t->columns) {
                 std::string aliasName;                
                 // no alias, add original name
@@ -722,6 +783,76 @@ public:
         }
         workingTable.columns = workingColumns;
 
+        // the where clause is on the joined columns, by the names they have after aliasing, each of which must be in exactly one joined table
+        std::shared_ptr<node> whereClauseRoot = joinWhereClause(joinRoot);
+        if (whereClauseRoot->type != nullnode) {
+            std::vector<size_t> tableColumns;
+            for (auto& t : joinedTables)
+                tableColumns.push_back(t->columns.size());
+            auto columnTables = joinedColumnTables(workingColumns, tableColumns);
+            std::vector<std::string> whereColumns;
+            comparedColumns(whereClauseRoot->components[0], whereColumns);
+            for (auto& columnName : whereColumns) {
+                if (hasDot(columnName) || columnTables.count(columnName))
+                    continue;
+                if (exists(columnName, workingColumns)) {
+                    throw QueryError() << "Validator error. Column \"" << columnName << "\" in the where clause is a column of more than one joined table, "
+                                       << "so it can't tell which is meant. A table joined with itself has each of its columns twice.\n";
+                }
+                QueryError error;
+                error << "Validator error. Column \"" << columnName << "\" in the where clause doesn't exist in ";
+                for (size_t i = 0; i < tableNames.size(); ++i)
+                    error << (i == 0 ? "" : i + 1 == tableNames.size() ? " or " : ", ") << "table \"" << tableNames[i] << "\"";
+                throw error << ".\n";
+            }
+        }
+        validateWhereClause(whereClauseRoot, workingTable);
+
+        // COLUMN LIST
+        std::shared_ptr<node> columnListRoot = joinColumnList(joinRoot);
+        if (columnListRoot->type == nullnode || columnListRoot->components[0]->type == asterisk)
+            return;
+
+        // selected columns must be in table.column form, of the joined tables, and selected once.
+        // a table joined with itself: a column selected a second time is the second copy's
+        std::vector<size_t> selectedColumns;
+        for (auto& col : columnListRoot->components) {
+            if (!hasDot(col->value)) {
+                throw QueryError() << "Validator error. Selected column \"" << col->value << "\" is not in table.column form.\n";
+            }
+            auto selectedName = split(col->value);
+            size_t index = std::find(tableNames.begin(), tableNames.end(), selectedName.first) - tableNames.begin();
+            if (index == tableNames.size()) {
+                throw QueryError() << "Validator error. Selected column \"" << col->value << "\" references table \"" << selectedName.first
+                                   << "\", which is " << (tableNames.size() == 2 ? "neither" : "not one") << " of the joined tables.\n";
+            }
+            auto c = std::find_if(joinedTables[index]->columns.begin(), joinedTables[index]->columns.end(), [&selectedName](const auto& c){return c.name == selectedName.second;});
+            if (c == joinedTables[index]->columns.end()) {
+                throw QueryError() << "Validator error. Column \"" << selectedName.second << "\" isn't a column in table \"" << selectedName.first << "\".\n";
+            }
+            // its place among the joined columns
+            size_t column = c - joinedTables[index]->columns.begin();
+            for (size_t i = 0; i < index; ++i)
+                column += joinedTables[i]->columns.size();
+            if (std::find(selectedColumns.begin(), selectedColumns.end(), column) != selectedColumns.end()) {
+                if (tableNames.size() == 2 && tableNames[0] == tableNames[1] && index == 0)
+                    column += joinedTables[0]->columns.size();
+                else {
+                    throw QueryError() << "Validator error. Column \"" << col->value << "\" is selected more than once.\n";
+                }
+                if (std::find(selectedColumns.begin(), selectedColumns.end(), column) != selectedColumns.end()) {
+                    throw QueryError() << "Validator error. Column \"" << col->value << "\" is selected more than twice. Each copy of a table joined with itself has one.\n";
+                }
+            }
+            selectedColumns.push_back(column);
+        }
+
+        // the resulting table has only the selected columns, in the order they're selected
+        workingColumns.clear();
+        for (size_t column : selectedColumns)
+            workingColumns.push_back(workingTable.columns[column]);
+        workingTable.columns = workingColumns;
+
         // std::cout << "Join validated.\n\n";
     }
 
@@ -732,27 +863,23 @@ public:
         std::string table1Name = bagOpRoot->components[1]->value;
         std::string table2Name = bagOpRoot->components[2]->value;
         if (!exists(table1Name, tables)) {
-            std::cout << "Validator error. Table \"" << table1Name << "\" doesn't exist.\n";
-            exit(1);
+            throw QueryError() << "Validator error. Table \"" << table1Name << "\" doesn't exist.\n";
         }
         if (!exists(table2Name, tables)) {
-            std::cout << "Validator error. Table \"" << table2Name << "\" doesn't exist.\n";
-            exit(1);
+            throw QueryError() << "Validator error. Table \"" << table2Name << "\" doesn't exist.\n";
         }
 
         // cannot union|intersect tables with different numbers of columns
         auto first = find(table1Name, tables);
         auto second = find(table2Name, tables);
         if (first->columns.size() != second->columns.size()) {
-            std::cout << "Validator error. Tables \"" << table1Name << "\" and \"" << table2Name << "\" don't have the same number of columns.\n";
-            exit(1);
+            throw QueryError() << "Validator error. Tables \"" << table1Name << "\" and \"" << table2Name << "\" don't have the same number of columns.\n";
         }
         
         // cannot union|intersect tables with different column names
         for (const auto& c : first->columns) {
             if (!exists(c.name, second->columns)) {
-                std::cout << "Validator error. Tables \"" << table1Name << "\" and \"" << table2Name << "\" have different column names.\n";
-                exit(1);
+                throw QueryError() << "Validator error. Tables \"" << table1Name << "\" and \"" << table2Name << "\" have different column names.\n";
             }
         }
 
@@ -760,8 +887,7 @@ public:
         for (const auto& c : first->columns) {
             auto c2 = find(c.name, second->columns);
             if (c.type != c2->type) {
-                std::cout << "Validator error. Tables \"" << table1Name << "\" and \"" << table2Name << "\" have different column types.\n";
-                exit(1);
+                throw QueryError() << "Validator error. Tables \"" << table1Name << "\" and \"" << table2Name << "\" have different column types.\n";
             }
         }
 
@@ -785,8 +911,7 @@ public:
         // if table already exists
         std::string tableName = definitionRoot->components[1]->value;
         if (exists(tableName, tables)) {
-            std::cout << "Validator error. Table \"" << tableName << "\" already exists. Cannot define a table with the same name.\n";
-            exit(1);
+            throw QueryError() << "Validator error. Table \"" << tableName << "\" already exists. Cannot define a table with the same name.\n";
         }
 
         // bag the working table name to the new table's name
@@ -816,12 +941,10 @@ public:
             for (auto columnTypePair : definitionRoot->components[2]->components) {
                 if (columnTypePair->components[1]->type == kw_chars) {
                     if (stoi(columnTypePair->components[2]->value) <= 0) {
-                        std::cout << "Validator error. Column \"" << columnTypePair->components[0]->value << "\" in defined table \"" << definitionRoot->components[1]->value << "\" may not have a non-positive number of characters.\n";
-                        exit(1);
+                        throw QueryError() << "Validator error. Column \"" << columnTypePair->components[0]->value << "\" in defined table \"" << definitionRoot->components[1]->value << "\" may not have a non-positive number of characters.\n";
                     }
                     if (stoi(columnTypePair->components[2]->value) > 255) {
-                        std::cout << "Validator error. Column \"" << columnTypePair->components[0]->value << "\" in defined table \"" << definitionRoot->components[1]->value << "\" may not have more than 255 characters.\n";
-                        exit(1);
+                        throw QueryError() << "Validator error. Column \"" << columnTypePair->components[0]->value << "\" in defined table \"" << definitionRoot->components[1]->value << "\" may not have more than 255 characters.\n";
                     }
                 }
             }
@@ -830,8 +953,7 @@ public:
             for (auto columnTypePair : definitionRoot->components[2]->components) {
                 std::string colName = columnTypePair->components[0]->value;
                 if (hasDot(colName)) {
-                    std::cout << "Validator error. Attempted to define table \"" << tableName << "\", but column \"" << colName << "\" has a dot. Try \"" << split(colName).second << "\".\n";
-                    exit(1);
+                    throw QueryError() << "Validator error. Attempted to define table \"" << tableName << "\", but column \"" << colName << "\" has a dot. Try \"" << split(colName).second << "\".\n";
                 }
             }
 
@@ -839,8 +961,7 @@ public:
             std::vector<std::string> names;
             for (auto columnTypePair : definitionRoot->components[2]->components) {
                 if (std::find(names.begin(), names.end(), columnTypePair->components[0]->value) != names.end()) {
-                    std::cout << "Validator error. More than one definition of column \"" << columnTypePair->components[0]->value << "\" in definition of table \"" << tableName << "\".\n";
-                    exit(1);
+                    throw QueryError() << "Validator error. More than one definition of column \"" << columnTypePair->components[0]->value << "\" in definition of table \"" << tableName << "\".\n";
                 }
                 names.push_back(columnTypePair->components[0]->value);
             }
@@ -863,8 +984,7 @@ public:
 
         // if table is in neither, error
         else {
-            std::cout << "Validator error. Table \"" << tableName << "\" doesn't exist.\n";
-            exit(1);
+            throw QueryError() << "Validator error. Table \"" << tableName << "\" doesn't exist.\n";
         }
 
         // std::cout << "Drop statement validated.\n";
@@ -872,6 +992,14 @@ public:
         // std::cout << '\n';
         return;
     }
+
+    // validate output statement
+    void validateOutput(std::shared_ptr<node> outputRoot) {
+        std::string format = outputRoot->components[0]->value;
+        if (format != "pretty" && format != "csv" && format != "tsv" && format != "binary") {
+            throw QueryError() << "Validator error. Unknown output format \"" << format << "\". Try pretty, csv, tsv, or binary.\n";
+        }
+    }
     
 };
 